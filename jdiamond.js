@@ -39,6 +39,9 @@ const Diamond = ffi.Library(libpath, {
   // Engine2D
   'dEngine2DConfigureGraphics': ['void', ['string', 'int', 'int', 'bool', 'bool']],
   'dEngine2DConfigureAudio': ['void', ['int', 'int', 'int']],
+  'dEngine2DConfigurePhysics': ['void', ['int', 'int', 'bool']],
+  'dEngine2DConfigurePhysicsBackend': ['void', ['int']],
+  'dEngine2DConfigurePhysicsThreads': ['void', ['int', 'int']],
   'dEngine2DInit': ['bool', []],
   'dEngine2DDestroy': ['void', []],
   'dEngine2DLaunchGame': ['void', []],
@@ -65,13 +68,53 @@ const Diamond = ffi.Library(libpath, {
   'dTransform2SetScale': ['void', ['int', 'float', 'float']],
   'dTransform2GetScaleX': ['float', ['int']],
   'dTransform2GetScaleY': ['float', ['int']],
+
+  'dNode2DInit': ['bool', []],
+  'dNode2DDestroy': ['void', []],
+  'dNode2DMakeNode': ['int', ['int']],
+  'dNode2DDestroyNode': ['void', ['int']],
+  'dNode2DAddChild': ['bool', ['int', 'int']],
+  'dNode2DRemoveChild': ['bool', ['int', 'int']],
+  'dNode2DGetParent': ['int', ['int']],
+  'dNode2DSetLocalTransform': ['void', ['int', 'float', 'float', 'float', 'float', 'float']],
+  'dNode2DUpdate': ['void', []],
+
+  'dMover2DDestroyAll': ['void', []],
+  'dMover2DMakeMovers': ['void', ['pointer', 'int', 'pointer']],
+  'dMover2DDestroyMovers': ['void', ['pointer', 'int']],
+  'dMover2DGetVelocities': ['void', ['pointer', 'int', 'pointer']],
+  'dMover2DSetVelocities': ['void', ['pointer', 'int', 'pointer']],
+  'dMover2DGetAngularVelocities': ['void', ['pointer', 'int', 'pointer']],
+  'dMover2DSetAngularVelocities': ['void', ['pointer', 'int', 'pointer']],
+  'dMover2DSetAccelerations': ['void', ['pointer', 'int', 'pointer']],
+  'dMover2DSetAngularAccelerations': ['void', ['pointer', 'int', 'pointer']],
+  'dMover2DUpdate': ['void', ['int']],
+
+  'dTween2DDestroyAll': ['void', []],
+  'dTween2DMakeTween': ['int', ['int', 'pointer']],
+  'dTween2DThen': ['void', ['int', 'int']],
+  'dTween2DDestroyTween': ['void', ['int']],
+  'dTween2DDestroyTransformTweens': ['void', ['int']],
+  'dTween2DDestroyRenderComponentTweens': ['void', ['int']],
+  'dTween2DGetFinished': ['int', ['pointer', 'int']],
+  'dTween2DUpdate': ['void', ['int']],
+
+  'dSystems2DInit': ['bool', []],
+  'dSystems2DDestroy': ['void', []],
+  'dSystems2DGetTimings': ['int', ['pointer', 'int']],
   // Renderer2D
   'dRenderer2DInit': ['bool', []],
   'dRenderer2DDestroy': ['void', []],
   'dRenderer2DGetResolution': ['void', [intPtr, intPtr]],
   'dRenderer2DGetScreenResolution': ['void', [intPtr, intPtr]],
+  'dRenderer2DGetStats': ['void', ['pointer']],
   'dRenderer2DLoadTexture': ['int', ['string']],
+  'dRenderer2DLoadTextureAsync': ['int', ['string']],
+  'dRenderer2DUpdateTextureLoads': ['void', []],
+  'dRenderer2DPollTextureLoads': ['int', ['pointer', 'pointer', 'int']],
   'dRenderer2DDestroyTexture': ['void', ['int']],
+  'dRenderer2DSetTextureBudget': ['void', ['size_t']],
+  'dRenderer2DGetTextureMemoryStats': ['void', ['pointer']],
   'dRenderer2DMakeRenderComponent': ['int', ['int', 'int', 'int']],
   'dRenderer2DDestroyRenderComponent': ['void', ['int']],
   'dRenderComponent2DSetSprite': ['void', ['int', 'int']],
@@ -84,27 +127,69 @@ const Diamond = ffi.Library(libpath, {
   'dRenderComponent2DFlipY': ['void', ['int']],
   'dRenderComponent2DIsFlippedX': ['bool', ['int']],
   'dRenderComponent2DIsFlippedY': ['bool', ['int']],
+  // TextureAtlas2D
+  'dTextureAtlas2DLoad': ['int', ['pointer', 'int', 'int', 'pointer']],
+  'dTextureAtlas2DGetNumPages': ['int', ['int']],
+  'dTextureAtlas2DDestroy': ['void', ['int']],
+  'dTextureAtlas2DDestroyAll': ['void', []],
+  // Bundle
+  'dBundleOpen': ['int', ['string']],
+  'dBundleClose': ['void', ['int']],
+  'dBundleCloseAll': ['void', []],
+  'dBundleLoadTexture': ['int', ['int', 'string']],
+  'dBundleGetAnimation': ['bool', ['int', 'string', intPtr, intPtr, intPtr, intPtr, intPtr]],
+  'dBundleGetConfigSize': ['int', ['int', 'string']],
+  'dBundleGetConfigKey': ['string', ['int', 'string', 'int']],
+  'dBundleGetConfigValue': ['string', ['int', 'string', 'int']],
   // Animation2D
   'dAnimation2DLoadAnimationSheet': ['int', ['int', 'int', 'int', 'int', 'int']],
   'dAnimation2DDestroyAnimationSheet': ['void', ['int']],
   'dAnimation2DMakeAnimatorSheet': ['int', ['int', 'int']],
   'dAnimation2DDestroyAnimatorSheet': ['void', ['int']],
   'dAnimation2DSetAnimationSheet': ['void', ['int', 'int']],
+  'dAnimation2DPlay': ['void', ['int']],
+  'dAnimation2DPause': ['void', ['int']],
+  'dAnimation2DStop': ['void', ['int']],
+  'dAnimation2DIsPlaying': ['bool', ['int']],
+  'dAnimation2DSetLoop': ['void', ['int', 'bool']],
+  'dAnimation2DGetFinished': ['int', ['pointer', 'int']],
   'dAnimation2DUpdate': ['void', ['int']],
   'dAnimation2DDestroyAll': ['void', []],
   // Physics2D
   'dPhysics2DInit': ['bool', []],
   'dPhysics2DDestroy': ['void', []],
   'dPhysics2DMakeRigidbody': ['int', ['int']],
+  'dPhysics2DMakeRigidbodyFromDef': ['int', ['int', 'pointer']],
   'dPhysics2DDestroyRigidbody': ['void', ['int']],
-  'dPhysics2DMakeAABBCollider': ['int', ['int', 'float', 'float', 'float', 'float']],
+  'dPhysics2DGetRigidbodyType': ['int', ['int']],
+  'dPhysics2DRefreshStaticBody': ['void', ['int']],
+  'dPhysics2DGetVelocities': ['void', ['pointer', 'int', 'pointer']],
+  'dPhysics2DSetVelocities': ['void', ['pointer', 'int', 'pointer']],
+  'dPhysics2DGetAngularVelocities': ['void', ['pointer', 'int', 'pointer']],
+  'dPhysics2DSetAngularVelocities': ['void', ['pointer', 'int', 'pointer']],
+  'dPhysics2DApplyImpulses': ['void', ['pointer', 'int', 'pointer']],
+  'dPhysics2DMakeAABBCollider': ['int', ['int', 'float', 'float', 'float', 'float', 'pointer']],
   'dPhysics2DDestroyAABBCollider': ['void', ['int']],
   'dPhysics2DSetAABBCollider': ['void', ['int', 'float', 'float', 'float', 'float']],
-  'dPhysics2DMakeCircleCollider': ['int', ['int', 'float', 'float', 'float']],
+  'dPhysics2DMakeCircleCollider': ['int', ['int', 'float', 'float', 'float', 'pointer']],
   'dPhysics2DDestroyCircleCollider': ['void', ['int']],
   'dPhysics2DSetCircleCollider': ['void', ['int', 'float', 'float', 'float']],
-  'dPhysics2DMakePolyCollider': ['int', ['int', 'int']],
+  'dPhysics2DMakePolyCollider': ['int', ['int', 'int', 'pointer']],
   'dPhysics2DDestroyPolyCollider': ['void', ['int']],
+  'dPhysics2DSetPolyColliderPoints': ['void', ['int', 'pointer', 'int']],
+  'dPhysics2DSetColliderLayer': ['void', ['int', 'int', 'int']],
+  'dPhysics2DSetColliderFilter': ['void', ['int', 'int', 'pointer']],
+  'dPhysics2DSetLayersCollide': ['void', ['int', 'int', 'bool']],
+  'dPhysics2DGetCollisionEvents': ['int', ['pointer', 'int']],
+
+  'dPhysics2DRaycast': ['bool', ['pointer', 'pointer']],
+  'dPhysics2DRaycastBatch': ['int', ['pointer', 'int', 'pointer']],
+  'dPhysics2DQueryAABB': ['int', ['pointer', 'pointer', 'int']],
+  'dPhysics2DQueryCircle': ['int', ['pointer', 'pointer', 'int']],
+  'dPhysics2DQueryPoint': ['int', ['pointer', 'pointer', 'int']],
+  'dPhysics2DQueryAABBBatch': ['int', ['pointer', 'int', 'pointer', 'int', 'pointer']],
+  'dPhysics2DQueryCircleBatch': ['int', ['pointer', 'int', 'pointer', 'int', 'pointer']],
+  'dPhysics2DQueryPointBatch': ['int', ['pointer', 'int', 'pointer', 'int', 'pointer']],
   // ParticleSystem2D
   'dParticleSystem2DInit': ['bool', ['int']],
   'dParticleSystem2DDestroy': ['void', []],
@@ -143,6 +228,188 @@ const Diamond = ffi.Library(libpath, {
   'dDebugDrawPolyCollider': ['void', ['int', 'int', 'int', 'int', 'int']]
 });
 
+// must match CD_RENDER_STATS_MAX_LAYERS and the layout
+// of dRenderStats2D in CD_Renderer2D.h
+const RENDER_STATS_MAX_LAYERS = 32;
+const renderStatsBuf = Buffer.alloc(4 * (RENDER_STATS_MAX_LAYERS + 10));
+
+// AnimatorSheets by handle, for reporting finished animations
+const animatorObjects = new Map();
+var finishedAnimatorsBuf = Buffer.alloc(4 * 64);
+
+// one mover's handle and state, for the single-mover accessors
+const moverHandleBuf = Buffer.alloc(4);
+const moverStateBuf = Buffer.alloc(8);
+
+// must match CD_TWEEN_* in CD_Tween2D.h
+const TWEEN_PROPERTIES = {position: 0, rotation: 1, scale: 2, color: 3, alpha: 4};
+const TWEEN_YOYO = 0x1;
+const TWEEN_RELATIVE = 0x2;
+// must match CD_EASE_* in CD_Tween2D.h
+const EASINGS = {
+  linear: 0,
+  quadIn: 1, quadOut: 2, quadInOut: 3,
+  cubicIn: 4, cubicOut: 5, cubicInOut: 6,
+  sineIn: 7, sineOut: 8, sineInOut: 9,
+  backOut: 10, elasticOut: 11, bounceOut: 12
+};
+// must match the layout of dTweenDef2D in CD_Tween2D.h
+const tweenDefBuf = Buffer.alloc(36);
+// Tweens by handle, for reporting finished tweens
+const tweenObjects = new Map();
+var finishedTweensBuf = Buffer.alloc(4 * 64);
+
+// must match CD_SYSTEM_NAME_SIZE and the layout
+// of dSystemTiming2D in CD_Systems2D.h
+const SYSTEM_NAME_SIZE = 32;
+const SYSTEM_TIMING_SIZE = SYSTEM_NAME_SIZE + 4;
+var systemTimingsBuf = Buffer.alloc(SYSTEM_TIMING_SIZE * 8);
+
+// must match the layout of dTextureMemoryStats2D in CD_Renderer2D.h
+const textureMemoryStatsBuf = Buffer.alloc(48);
+
+const readInt64LE = function(buf, offset) {
+  return buf.readUInt32LE(offset) + buf.readInt32LE(offset + 4) * 0x100000000;
+}
+
+// must match CD_TEXTURE_* in CD_Renderer2D.h
+const TEXTURE_LOADED = 1;
+
+// finished texture loads are polled in batches of this size
+const TEXTURE_POLL_SIZE = 64;
+const texturePollHandlesBuf = Buffer.alloc(4 * TEXTURE_POLL_SIZE);
+const texturePollStatesBuf = Buffer.alloc(4 * TEXTURE_POLL_SIZE);
+
+// resolve functions of loadTextureAsync promises, by texture handle
+const pendingTextureLoads = new Map();
+
+// must match CD_PHYSICS_* in CD_Engine2D.h
+const PHYSICS_BACKENDS = ['quantum', 'native'];
+
+// must match CD_BODY_* and dRigidbodyDef2D in CD_Physics2D.h
+const BODY_TYPES = ['static', 'kinematic', 'dynamic'];
+const rigidbodyDefBuf = Buffer.alloc(4);
+// one rigidbody's handle and state, for the single-body accessors
+const rigidbodyHandleBuf = Buffer.alloc(4);
+const rigidbodyStateBuf = Buffer.alloc(8);
+
+// a Buffer over a typed array's memory, to pass it to native without copying
+function typedArrayBuf(array) {
+  return Buffer.from(array.buffer, array.byteOffset, array.byteLength);
+}
+
+// must match CD_COLLIDER_*, CD_COLLISION_* and the layout
+// of dCollisionEvent2D in CD_Physics2D.h
+const COLLIDER_CIRCLE = 1;
+const COLLIDER_POLY = 2;
+const COLLISION_STATES = ['enter', 'stay', 'exit'];
+
+// must match CD_CATEGORY_DEFAULT, CD_MASK_ALL and the layout
+// of dColliderFilter2D in CD_Physics2D.h
+const DEFAULT_CATEGORY = 0x1;
+const MASK_ALL = 0xFFFFFFFF;
+const colliderFilterBuf = Buffer.alloc(12);
+
+function writeColliderFilter(collider) {
+  colliderFilterBuf.writeInt32LE(collider.mLayer, 0);
+  colliderFilterBuf.writeUInt32LE(collider.mCategory >>> 0, 4);
+  colliderFilterBuf.writeUInt32LE(collider.mMask >>> 0, 8);
+  return colliderFilterBuf;
+}
+
+// sets up a collider's layer, category and mask from an optional
+// {layer, category, mask} object, any of which may be left out
+function initColliderFilter(collider, filter = {}) {
+  collider.mLayer = filter.layer || 0;
+  collider.mCategory = filter.category === undefined ? DEFAULT_CATEGORY : filter.category;
+  collider.mMask = filter.mask === undefined ? MASK_ALL : filter.mask;
+}
+const COLLISION_EVENT_SIZE = 20;
+var collisionEventsBuf = Buffer.alloc(COLLISION_EVENT_SIZE * 256);
+
+// jdiamond colliders by collider type and handle,
+// so that collision events can refer to them
+const colliderObjects = [new Map(), new Map(), new Map()];
+
+// must match the layouts of dRay2D, dRaycastHit2D,
+// the query structs and dColliderRef2D in CD_PhysicsQuery2D.h
+const RAY_SIZE = 24;
+const RAYCAST_HIT_SIZE = 28;
+const AABB_QUERY_SIZE = 24;
+const CIRCLE_QUERY_SIZE = 20;
+const POINT_QUERY_SIZE = 16;
+const COLLIDER_REF_SIZE = 8;
+const queryBuf = Buffer.alloc(RAY_SIZE);
+const raycastHitBuf = Buffer.alloc(RAYCAST_HIT_SIZE);
+var raysBuf = Buffer.alloc(RAY_SIZE * 64);
+var raycastHitsBuf = Buffer.alloc(RAYCAST_HIT_SIZE * 64);
+
+// x, y floats of a polygon collider's new points
+var polyPointsBuf = Buffer.alloc(8 * 16);
+var queryResultsBuf = Buffer.alloc(COLLIDER_REF_SIZE * 64);
+// for batched overlap queries
+var queriesBuf = Buffer.alloc(AABB_QUERY_SIZE * 64);
+var queryCountsBuf = Buffer.alloc(4 * 64);
+
+function colliderObject(buf, offset) {
+  const colliders = colliderObjects[buf.readInt32LE(offset)];
+  return colliders ? colliders.get(buf.readInt32LE(offset + 4)) || null : null;
+}
+
+// runs the overlap query in queryBuf, returning the colliders it found
+function queryColliders(query) {
+  let numFound = query(queryBuf, queryResultsBuf,
+                       queryResultsBuf.length / COLLIDER_REF_SIZE);
+  if (numFound * COLLIDER_REF_SIZE > queryResultsBuf.length) {
+    queryResultsBuf = Buffer.alloc(2 * numFound * COLLIDER_REF_SIZE);
+    numFound = query(queryBuf, queryResultsBuf,
+                     queryResultsBuf.length / COLLIDER_REF_SIZE);
+  }
+
+  const colliders = [];
+  for (let i = 0; i < numFound; ++i) {
+    const collider = colliderObject(queryResultsBuf, i * COLLIDER_REF_SIZE);
+    if (collider) colliders.push(collider);
+  }
+  return colliders;
+}
+
+// runs numQueries overlap queries of querySize bytes each, written into
+// queriesBuf by write(offset, i), with the given batched query function.
+// returns an array with the colliders found by each query.
+function queryCollidersBatch(queryBatch, numQueries, querySize, write) {
+  if (queriesBuf.length < numQueries * querySize)
+    queriesBuf = Buffer.alloc(2 * numQueries * querySize);
+  if (queryCountsBuf.length < 4 * numQueries)
+    queryCountsBuf = Buffer.alloc(8 * numQueries);
+
+  for (let i = 0; i < numQueries; ++i)
+    write(i * querySize, i);
+
+  // a full results buffer may have cut off some results, so grow and retry
+  let maxResults = queryResultsBuf.length / COLLIDER_REF_SIZE;
+  let numResults;
+  while ((numResults = queryBatch(queriesBuf, numQueries, queryResultsBuf,
+                                  maxResults, queryCountsBuf)) === maxResults &&
+         maxResults > 0) {
+    queryResultsBuf = Buffer.alloc(2 * queryResultsBuf.length);
+    maxResults = queryResultsBuf.length / COLLIDER_REF_SIZE;
+  }
+
+  const found = [];
+  let result = 0;
+  for (let i = 0; i < numQueries; ++i) {
+    const colliders = [];
+    const count = queryCountsBuf.readInt32LE(4 * i);
+    for (let j = 0; j < count; ++j, ++result) {
+      const collider = colliderObject(queryResultsBuf, result * COLLIDER_REF_SIZE);
+      if (collider) colliders.push(collider);
+    }
+    found.push(colliders);
+  }
+  return found;
+}
+
 // shallow copies an object
 function copyObj(from, to) {
   Object.assign(to, from)
@@ -187,6 +454,22 @@ exports.Config = function() {
   // estimate for the max number of particles
   // that may be present at any time.
   this.particlePoolSize = 100;
+  // length of each physics step in whole milliseconds,
+  // or 0 to step physics once per frame by the frame's delta.
+  // with a fixed step, physics takes at most maxPhysicsSubsteps steps
+  // per frame, and transforms are shown interpolated between the last
+  // two steps if interpolatePhysics is true.
+  this.physicsFixedStep = 0;
+  this.maxPhysicsSubsteps = 8;
+  this.interpolatePhysics = true;
+  // 'quantum' for the engine's own physics world,
+  // or 'native' for CDiamond's, which scales to more bodies.
+  this.physicsBackend = 'quantum';
+  // threads that syncing transforms and (with the native world)
+  // moving bodies are split across, counting the game loop's thread,
+  // once there are at least minBodiesPerPhysicsThread bodies per thread.
+  this.physicsThreads = 1;
+  this.minBodiesPerPhysicsThread = 4096;
   this.benchmark = false;
   this.benchmarkFile = "benchmark.log";
 }
@@ -213,12 +496,26 @@ exports.init = function(config) {
     config.audioFrequency,
     config.audioSampleSize
   );
+  Diamond.dEngine2DConfigurePhysics(
+    config.physicsFixedStep,
+    config.maxPhysicsSubsteps,
+    config.interpolatePhysics
+  );
+  Diamond.dEngine2DConfigurePhysicsBackend(
+    PHYSICS_BACKENDS.indexOf(config.physicsBackend)
+  );
+  Diamond.dEngine2DConfigurePhysicsThreads(
+    config.physicsThreads,
+    config.minBodiesPerPhysicsThread
+  );
 
   if (config.benchmark)
     Diamond.dGame2DBenchmark(config.benchmarkFile);
 
   if (!(Diamond.dEngine2DInit() &&
         Diamond.dTransform2Init() &&
+        Diamond.dNode2DInit() &&
+        Diamond.dSystems2DInit() &&
         Diamond.dRenderer2DInit() &&
         Diamond.dPhysics2DInit() &&
         Diamond.dParticleSystem2DInit(config.particlePoolSize) &&
@@ -240,6 +537,8 @@ exports.init = function(config) {
  var updateCB = ref.NULL;
  // args {
  //     update,
+ //     // called with the delta and the last physics step's
+ //     // collisions (see physics.collisions)
  //     postPhysicsUpdate,
  //     quit,
  //     postQuit,
@@ -252,15 +551,15 @@ exports.launch = function(args) {
       args.update(delta);
     }
 
-    // update Diamond's non-core systems (ex. particles)
-    // that aren't automatically updated within
-    // Diamond Engine's game loop.
-    Diamond.dAnimation2DUpdate(delta);
-    Diamond.dParticleSystem2DUpdate(delta);
+    // animation, particles and other native systems are
+    // updated by the backend right after this (see exports.systems).
+    exports.renderer.updateTextureLoads();
   });
 
   if (args && args.postPhysicsUpdate) {
-    postPhysicsUpdateCB = ffi.Callback('void', ['int'], args.postPhysicsUpdate);
+    postPhysicsUpdateCB = ffi.Callback('void', ['int'], function(delta) {
+      args.postPhysicsUpdate(delta, exports.physics.collisions);
+    });
   }
   if (args && args.quit) {
     quitCB = ffi.Callback('void', [], args.quit);
@@ -292,16 +591,65 @@ exports.quit = function() {
  */
 exports.cleanUp = function() {
   Diamond.dGame2DDestroy();
+  Diamond.dSystems2DDestroy();
+  Diamond.dMover2DDestroyAll();
+  Diamond.dTween2DDestroyAll();
+  tweenObjects.clear();
   Diamond.dConfigDestroyAll();
   Diamond.dDebugDrawDestroy();
   Diamond.dParticleSystem2DDestroy();
   Diamond.dPhysics2DDestroy();
+  colliderObjects.forEach(colliders => colliders.clear());
   Diamond.dAnimation2DDestroyAll();
+  animatorObjects.clear();
+  Diamond.dTextureAtlas2DDestroyAll();
+  Diamond.dBundleCloseAll();
   Diamond.dRenderer2DDestroy();
+  pendingTextureLoads.clear();
+  Diamond.dNode2DDestroy();
+  nodeTransforms.clear();
   Diamond.dTransform2Destroy();
   Diamond.dEngine2DDestroy();
 }
 
+// The native systems that the backend updates each frame, in order,
+// right after the update callback and before physics.
+exports.systems = {
+  // [{name, timeMs}] for each system's last update
+  get timings() {
+    let numSystems = Diamond.dSystems2DGetTimings(
+      systemTimingsBuf, systemTimingsBuf.length / SYSTEM_TIMING_SIZE
+    );
+    if (numSystems * SYSTEM_TIMING_SIZE > systemTimingsBuf.length) {
+      systemTimingsBuf = Buffer.alloc(2 * numSystems * SYSTEM_TIMING_SIZE);
+      numSystems = Diamond.dSystems2DGetTimings(systemTimingsBuf, 2 * numSystems);
+    }
+
+    const timings = [];
+    for (let i = 0; i < numSystems; ++i) {
+      const offset = i * SYSTEM_TIMING_SIZE;
+      const nameEnd = systemTimingsBuf.indexOf(0, offset);
+      timings.push({
+        name: systemTimingsBuf.toString('utf8', offset, nameEnd),
+        timeMs: systemTimingsBuf.readFloatLE(offset + SYSTEM_NAME_SIZE)
+      });
+    }
+    return timings;
+  }
+}
+
+// the transforms that have nodes, by node handle, for looking up parents
+var nodeTransforms = new Map();
+
+/**
+ * Moves the children of transforms that were moved since the last update.
+ * The game loop does this after update and after each physics step,
+ * so this only needs to be called to see children move sooner.
+ */
+exports.updateNodes = function() {
+  Diamond.dNode2DUpdate();
+}
+
 // Objects of the following classes reference their corresponding
 // objects in the Diamond backend using a handle.
 
@@ -335,11 +683,61 @@ exports.Transform2 = class Transform2 {
     this.handle = Diamond.dTransform2MakeTransform(
       position.x, position.y, rotation, scale.x, scale.y
     );
+    this.node = undefined;
   }
   destroy() {
+    if (this.mover)
+      this.mover.destroy();
+    if (this.hasTweens)
+      Diamond.dTween2DDestroyTransformTweens(this.handle);
+    if (this.node !== undefined) {
+      Diamond.dNode2DDestroyNode(this.node);
+      nodeTransforms.delete(this.node);
+    }
     Diamond.dTransform2DestroyTransform(this.handle);
   }
 
+  // makes the Diamond node that parents this transform on first use
+  get nodeHandle() {
+    if (this.node === undefined) {
+      this.node = Diamond.dNode2DMakeNode(this.handle);
+      nodeTransforms.set(this.node, this);
+    }
+    return this.node;
+  }
+
+  // child keeps its world transform and moves with this transform from
+  // then on. returns false if child is this transform or one of its parents.
+  addChild(child) {
+    return Diamond.dNode2DAddChild(this.nodeHandle, child.nodeHandle);
+  }
+
+  // child keeps its world transform. returns false if
+  // child isn't a child of this transform.
+  removeChild(child) {
+    if (this.node === undefined || child.node === undefined)
+      return false;
+    return Diamond.dNode2DRemoveChild(this.node, child.node);
+  }
+
+  // null if this transform has no parent
+  get parent() {
+    if (this.node === undefined)
+      return null;
+    let parent = nodeTransforms.get(Diamond.dNode2DGetParent(this.node));
+    return parent ? parent : null;
+  }
+
+  // sets this transform relative to its parent,
+  // which takes effect at the next node update.
+  setLocal(position = {x: 0, y: 0},
+           rotation = 0,
+           scale    = {x: 1, y: 1}) {
+    Diamond.dNode2DSetLocalTransform(
+      this.nodeHandle, position.x, position.y, rotation, scale.x, scale.y
+    );
+  }
+
   get obj() {
     let objref = {
       position: this.position,
@@ -421,10 +819,99 @@ exports.renderer = {
       return null;
     return {handle: handle}
   },
+  // Returns a promise that resolves to the texture once it has been
+  // decoded in the background and uploaded by updateTextureLoads,
+  // or to null if it failed to load.
+  loadTextureAsync: function(path) {
+    return new Promise(resolve => {
+      const handle = Diamond.dRenderer2DLoadTextureAsync(path);
+      pendingTextureLoads.set(handle, resolve);
+    });
+  },
+  // Uploads finished asynchronous texture loads and resolves their promises.
+  // Called every frame by the game loop.
+  updateTextureLoads: function() {
+    if (pendingTextureLoads.size == 0)
+      return;
+
+    Diamond.dRenderer2DUpdateTextureLoads();
+
+    let numLoads;
+    do {
+      numLoads = Diamond.dRenderer2DPollTextureLoads(
+        texturePollHandlesBuf, texturePollStatesBuf, TEXTURE_POLL_SIZE
+      );
+      for (let i = 0; i < numLoads; ++i) {
+        const handle = texturePollHandlesBuf.readInt32LE(4 * i);
+        const state = texturePollStatesBuf.readInt32LE(4 * i);
+        const resolve = pendingTextureLoads.get(handle);
+        pendingTextureLoads.delete(handle);
+        if (resolve)
+          resolve(state == TEXTURE_LOADED ? {handle: handle} : null);
+      }
+    } while (numLoads == TEXTURE_POLL_SIZE);
+  },
   destroyTexture: function(texture) {
     Diamond.dRenderer2DDestroyTexture(texture.handle);
   },
 
+  // memory used by textures loaded from files, in bytes.
+  // unused textures stay loaded until the budget is exceeded.
+  get textureMemory() {
+    Diamond.dRenderer2DGetTextureMemoryStats(textureMemoryStatsBuf);
+
+    return {
+      bytes: readInt64LE(textureMemoryStatsBuf, 0),
+      referencedBytes: readInt64LE(textureMemoryStatsBuf, 8),
+      budget: readInt64LE(textureMemoryStatsBuf, 16),
+      numTextures: textureMemoryStatsBuf.readInt32LE(24),
+      numReferenced: textureMemoryStatsBuf.readInt32LE(28),
+      hits: textureMemoryStatsBuf.readInt32LE(32),
+      misses: textureMemoryStatsBuf.readInt32LE(36),
+      evictions: textureMemoryStatsBuf.readInt32LE(40)
+    };
+  },
+  set textureBudget(bytes) {
+    Diamond.dRenderer2DSetTextureBudget(bytes);
+  },
+
+  // Packs the images at the given paths into shared atlas pages.
+  // Returns the atlas, whose textures map each path
+  // to a texture (or null if it failed to load),
+  // or null if none of the images could be packed.
+  // Atlas textures are freed with destroyAtlas, not destroyTexture.
+  loadAtlas: function(paths, pageSize = 2048) {
+    const pathsbuf = Buffer.alloc(ref.sizeof.pointer * paths.length);
+    const texturesbuf = Buffer.alloc(4 * paths.length);
+
+    // keep the path strings referenced until the call returns
+    const pathstrs = paths.map(path => ref.allocCString(path));
+    pathstrs.forEach((pathstr, i) => {
+      ref.writePointer(pathsbuf, i * ref.sizeof.pointer, pathstr);
+    });
+
+    const handle = Diamond.dTextureAtlas2DLoad(
+      pathsbuf, paths.length, pageSize, texturesbuf
+    );
+    if (handle < 0)
+      return null;
+
+    const textures = {};
+    paths.forEach((path, i) => {
+      const texture = texturesbuf.readInt32LE(4 * i);
+      textures[path] = texture < 0 ? null : {handle: texture};
+    });
+
+    return {
+      handle: handle,
+      numPages: Diamond.dTextureAtlas2DGetNumPages(handle),
+      textures: textures
+    };
+  },
+  destroyAtlas: function(atlas) {
+    Diamond.dTextureAtlas2DDestroy(atlas.handle);
+  },
+
   get resolution() {
     var xbuf = ref.alloc('int');
     var ybuf = ref.alloc('int');
@@ -446,9 +933,91 @@ exports.renderer = {
       x: xbuf.deref(),
       y: ybuf.deref()
     };
+  },
+
+  // counters for the last rendered frame.
+  // drawCalls, textureSwitches, colorModChanges and alphaModChanges are
+  // estimates worked out from the render components in the order they
+  // were made, not counters read from SDL.
+  get stats() {
+    Diamond.dRenderer2DGetStats(renderStatsBuf);
+
+    const numLayers = renderStatsBuf.readInt32LE(0);
+    const objectsPerLayer = [];
+    for (let i = 0; i < numLayers; ++i) {
+      objectsPerLayer.push(renderStatsBuf.readInt32LE(4 * (i + 1)));
+    }
+
+    const offset = 4 * (RENDER_STATS_MAX_LAYERS + 1);
+    return {
+      objectsPerLayer: objectsPerLayer,
+      objects: renderStatsBuf.readInt32LE(offset),
+      drawCalls: renderStatsBuf.readInt32LE(offset + 4),
+      textureSwitches: renderStatsBuf.readInt32LE(offset + 8),
+      colorModChanges: renderStatsBuf.readInt32LE(offset + 12),
+      alphaModChanges: renderStatsBuf.readInt32LE(offset + 16),
+      culled: renderStatsBuf.readInt32LE(offset + 20),
+      pointsQueued: renderStatsBuf.readInt32LE(offset + 24),
+      linesQueued: renderStatsBuf.readInt32LE(offset + 28),
+      renderTimeMs: renderStatsBuf.readFloatLE(offset + 32)
+    };
   }
 }
 
+// Asset bundles made with the cdbundle tool (src/CDiamond/tools/bundle).
+// Textures loaded from a bundle are freed when it is closed.
+exports.bundle = {
+  open: function(path) {
+    const handle = Diamond.dBundleOpen(path);
+    if (handle < 0)
+      return null;
+    return {handle: handle};
+  },
+  close: function(bundle) {
+    Diamond.dBundleClose(bundle.handle);
+  },
+
+  loadTexture: function(bundle, name) {
+    const handle = Diamond.dBundleLoadTexture(bundle.handle, name);
+    if (handle < 0)
+      return null;
+    return {handle: handle};
+  },
+
+  // returns an animation for AnimatorSheet, or null
+  loadAnimation: function(bundle, name) {
+    const bufs = [];
+    for (let i = 0; i < 5; ++i) {
+      bufs.push(ref.alloc('int'));
+    }
+
+    if (!Diamond.dBundleGetAnimation(bundle.handle, name, ...bufs))
+      return null;
+
+    return {
+      spritesheet: {handle: bufs[0].deref()},
+      frameLength: bufs[1].deref(),
+      numFrames: bufs[2].deref(),
+      numRows: bufs[3].deref(),
+      numColumns: bufs[4].deref()
+    };
+  },
+
+  // returns the config's key-value pairs as an object of strings, or null
+  loadConfig: function(bundle, name) {
+    const size = Diamond.dBundleGetConfigSize(bundle.handle, name);
+    if (size < 0)
+      return null;
+
+    const config = {};
+    for (let i = 0; i < size; ++i) {
+      config[Diamond.dBundleGetConfigKey(bundle.handle, name, i)] =
+        Diamond.dBundleGetConfigValue(bundle.handle, name, i);
+    }
+    return config;
+  }
+};
+
 exports.RenderComponent2D = class RenderComponent2D {
   constructor(transform, texture, layer = 0) {
     this.texture = texture;
@@ -457,6 +1026,8 @@ exports.RenderComponent2D = class RenderComponent2D {
     );
   }
   destroy() {
+    if (this.hasTweens)
+      Diamond.dTween2DDestroyRenderComponentTweens(this.handle);
     Diamond.dRenderer2DDestroyRenderComponent(this.handle);
   }
 
@@ -530,6 +1101,16 @@ exports.RenderComponent2D = class RenderComponent2D {
   }
 }
 
+const loadAnimationSheet = function(animation) {
+  return Diamond.dAnimation2DLoadAnimationSheet(
+    animation.spritesheet.handle,
+    animation.frameLength,
+    animation.numFrames,
+    animation.numRows,
+    animation.numColumns
+  );
+}
+
 // animation =
 // {
 //   spritesheet: Diamond texture,
@@ -539,24 +1120,50 @@ exports.RenderComponent2D = class RenderComponent2D {
 //   numColumns: int
 // }
 exports.AnimatorSheet = class AnimatorSheet {
-  constructor(animation, renderComponent) {
+  constructor(animation, renderComponent, loop = true) {
     this.mAnimation = {};
     copyObj(animation, this.mAnimation);
 
-    this.animationHandle = Diamond.dAnimation2DLoadAnimationSheet(
-      animation.spritesheet.handle,
-      animation.frameLength,
-      animation.numFrames,
-      animation.numRows,
-      animation.numColumns
-    );
+    this.animationHandle = loadAnimationSheet(animation);
     this.handle = Diamond.dAnimation2DMakeAnimatorSheet(
       renderComponent.handle, this.animationHandle
     );
+    animatorObjects.set(this.handle, this);
+    this.mLoop = true;
+    if (!loop)
+      this.loop = false;
   }
   destroy() {
     Diamond.dAnimation2DDestroyAnimatorSheet(this.handle);
     Diamond.dAnimation2DDestroyAnimationSheet(this.animationHandle);
+    animatorObjects.delete(this.handle);
+  }
+
+  // paused and finished animators cost nothing per frame.
+  // playing a finished animator starts it over, and
+  // stop pauses it on its first frame.
+  play() {
+    Diamond.dAnimation2DPlay(this.handle);
+  }
+  pause() {
+    Diamond.dAnimation2DPause(this.handle);
+  }
+  stop() {
+    Diamond.dAnimation2DStop(this.handle);
+  }
+
+  get isPlaying() {
+    return Diamond.dAnimation2DIsPlaying(this.handle);
+  }
+
+  // an animator that doesn't loop finishes after its last frame
+  // (see animation.finished), and stays on that frame.
+  get loop() {
+    return this.mLoop;
+  }
+  set loop(loop) {
+    this.mLoop = loop;
+    Diamond.dAnimation2DSetLoop(this.handle, loop);
   }
 
   get obj() { return this.animation; }
@@ -572,46 +1179,573 @@ exports.AnimatorSheet = class AnimatorSheet {
     return this.mAnimation;
   }
 
+  // animation sheets are shared in the backend, so switching to
+  // an animation that's already in use doesn't load anything.
   set animation(animation) {
     this.mAnimation = animation;
-    Diamond.dAnimation2DDestroyAnimationSheet(this.animationHandle);
-    this.animationHandle = Diamond.dAnimation2DLoadAnimationSheet(
-      animation.spritesheet.handle,
-      animation.frameLength,
-      animation.numFrames,
-      animation.numRows,
-      animation.numColumns
-    );
+    const oldHandle = this.animationHandle;
+    this.animationHandle = loadAnimationSheet(animation);
     Diamond.dAnimation2DSetAnimationSheet(this.handle, this.animationHandle);
+    Diamond.dAnimation2DDestroyAnimationSheet(oldHandle);
   }
 }
 
 
+exports.animation = {
+  // the AnimatorSheets that finished in the last frame.
+  // read from native in one call, so read it once per frame.
+  get finished() {
+    let numFinished = Diamond.dAnimation2DGetFinished(
+      finishedAnimatorsBuf, finishedAnimatorsBuf.length / 4
+    );
+    if (4 * numFinished > finishedAnimatorsBuf.length) {
+      finishedAnimatorsBuf = Buffer.alloc(8 * numFinished);
+      numFinished = Diamond.dAnimation2DGetFinished(finishedAnimatorsBuf, 2 * numFinished);
+    }
+
+    const finished = [];
+    for (let i = 0; i < numFinished; ++i) {
+      finished.push(animatorObjects.get(finishedAnimatorsBuf.readInt32LE(4 * i)));
+    }
+    return finished;
+  }
+}
+
+
+// Moves a Transform2 by its velocity and angular velocity every frame,
+// natively and without a rigidbody, ex. for bullets and decorations.
+// velocities are in position units (or degrees) per millisecond, and
+// accelerations in position units (or degrees) per millisecond per millisecond.
+// to move many transforms, use the bulk functions in movers.
+exports.Mover = class Mover {
+  constructor(transform) {
+    moverHandleBuf.writeInt32LE(transform.handle, 0);
+    Diamond.dMover2DMakeMovers(moverHandleBuf, 1, moverHandleBuf);
+    this.handle = moverHandleBuf.readInt32LE(0);
+    this.transform = transform;
+    this.mAcceleration = {x: 0, y: 0};
+    this.mAngularAcceleration = 0;
+    // so that destroying the transform destroys its mover
+    transform.mover = this;
+  }
+  destroy() {
+    moverHandleBuf.writeInt32LE(this.handle, 0);
+    Diamond.dMover2DDestroyMovers(moverHandleBuf, 1);
+    this.transform.mover = undefined;
+  }
+
+  get velocity() {
+    moverHandleBuf.writeInt32LE(this.handle, 0);
+    Diamond.dMover2DGetVelocities(moverHandleBuf, 1, moverStateBuf);
+    return {x: moverStateBuf.readFloatLE(0), y: moverStateBuf.readFloatLE(4)};
+  }
+
+  set velocity(velocity) {
+    moverHandleBuf.writeInt32LE(this.handle, 0);
+    moverStateBuf.writeFloatLE(velocity.x, 0);
+    moverStateBuf.writeFloatLE(velocity.y, 4);
+    Diamond.dMover2DSetVelocities(moverHandleBuf, 1, moverStateBuf);
+  }
+
+  get angularVelocity() {
+    moverHandleBuf.writeInt32LE(this.handle, 0);
+    Diamond.dMover2DGetAngularVelocities(moverHandleBuf, 1, moverStateBuf);
+    return moverStateBuf.readFloatLE(0);
+  }
+
+  set angularVelocity(angularVelocity) {
+    moverHandleBuf.writeInt32LE(this.handle, 0);
+    moverStateBuf.writeFloatLE(angularVelocity, 0);
+    Diamond.dMover2DSetAngularVelocities(moverHandleBuf, 1, moverStateBuf);
+  }
+
+  // accelerations only change when set, so they're kept on this side too
+  get acceleration() {
+    return {x: this.mAcceleration.x, y: this.mAcceleration.y};
+  }
+
+  set acceleration(acceleration) {
+    this.mAcceleration = {x: acceleration.x, y: acceleration.y};
+    moverHandleBuf.writeInt32LE(this.handle, 0);
+    moverStateBuf.writeFloatLE(acceleration.x, 0);
+    moverStateBuf.writeFloatLE(acceleration.y, 4);
+    Diamond.dMover2DSetAccelerations(moverHandleBuf, 1, moverStateBuf);
+  }
+
+  get angularAcceleration() {
+    return this.mAngularAcceleration;
+  }
+
+  set angularAcceleration(angularAcceleration) {
+    this.mAngularAcceleration = angularAcceleration;
+    moverHandleBuf.writeInt32LE(this.handle, 0);
+    moverStateBuf.writeFloatLE(angularAcceleration, 0);
+    Diamond.dMover2DSetAngularAccelerations(moverHandleBuf, 1, moverStateBuf);
+  }
+}
+
+// Bulk movers, to move many transforms (ex. a volley of bullets) with
+// one native call each. handles are Int32Arrays of mover handles.
+// velocities and accelerations are Float32Arrays of x, y pairs, one per
+// mover, and angular ones are Float32Arrays with one per mover.
+// the arrays are passed to native without copying.
+// destroy movers made here before destroying their transforms.
+exports.movers = {
+  // makes a mover at rest for each Transform2 in transforms
+  make(transforms, handles = new Int32Array(transforms.length)) {
+    const transformHandles = Int32Array.from(transforms, transform => transform.handle);
+    Diamond.dMover2DMakeMovers(
+      typedArrayBuf(transformHandles), transforms.length, typedArrayBuf(handles)
+    );
+    return handles;
+  },
+
+  destroy(handles) {
+    Diamond.dMover2DDestroyMovers(typedArrayBuf(handles), handles.length);
+  },
+
+  getVelocities(handles, velocities = new Float32Array(2 * handles.length)) {
+    Diamond.dMover2DGetVelocities(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(velocities)
+    );
+    return velocities;
+  },
+
+  setVelocities(handles, velocities) {
+    Diamond.dMover2DSetVelocities(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(velocities)
+    );
+  },
+
+  getAngularVelocities(handles, angularVelocities = new Float32Array(handles.length)) {
+    Diamond.dMover2DGetAngularVelocities(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(angularVelocities)
+    );
+    return angularVelocities;
+  },
+
+  setAngularVelocities(handles, angularVelocities) {
+    Diamond.dMover2DSetAngularVelocities(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(angularVelocities)
+    );
+  },
+
+  setAccelerations(handles, accelerations) {
+    Diamond.dMover2DSetAccelerations(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(accelerations)
+    );
+  },
+
+  setAngularAccelerations(handles, angularAccelerations) {
+    Diamond.dMover2DSetAngularAccelerations(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(angularAccelerations)
+    );
+  },
+
+  // moves all movers by delta milliseconds. the game loop does this
+  // each update, so this only needs to be called outside of it.
+  update(delta) {
+    Diamond.dMover2DUpdate(delta);
+  }
+}
+
+// Tweens a property of a Transform2 ('position', 'rotation' or 'scale')
+// or of a RenderComponent2D ('color' or 'alpha') to the value to,
+// given as {x, y}, a number, or {r, g, b} from 0 to 255.
+// the tween runs natively from the value the property has once
+// its delay is over, and is freed when it finishes (see tween.finished).
+// options {
+//   duration, // milliseconds, 1000 by default
+//   delay,    // milliseconds, 0 by default
+//   easing,   // 'linear' (default), 'quadIn', 'quadOut', 'quadInOut', 'cubicIn',
+//             // 'cubicOut', 'cubicInOut', 'sineIn', 'sineOut', 'sineInOut',
+//             // 'backOut', 'elasticOut' or 'bounceOut'
+//   loops,    // times to play again after the first, -1 for forever
+//   yoyo,     // if true, every other loop plays backwards
+//   relative  // if true, to is added to the starting value
+// }
+exports.Tween = class Tween {
+  constructor(target, property, to, options = {}) {
+    const type = TWEEN_PROPERTIES[property];
+    let values;
+    if (property === 'position' || property === 'scale')
+      values = [to.x, to.y, 0];
+    else if (property === 'color')
+      values = [to.r, to.g, to.b];
+    else
+      values = [to, 0, 0];
+
+    tweenDefBuf.writeInt32LE(type, 0);
+    for (let i = 0; i < 3; ++i)
+      tweenDefBuf.writeFloatLE(values[i], 4 + 4 * i);
+    tweenDefBuf.writeInt32LE(options.duration !== undefined ? options.duration : 1000, 16);
+    tweenDefBuf.writeInt32LE(options.delay || 0, 20);
+    tweenDefBuf.writeInt32LE(EASINGS[options.easing || 'linear'], 24);
+    tweenDefBuf.writeInt32LE(options.loops || 0, 28);
+    tweenDefBuf.writeInt32LE((options.yoyo ? TWEEN_YOYO : 0) |
+                             (options.relative ? TWEEN_RELATIVE : 0), 32);
+
+    this.handle = Diamond.dTween2DMakeTween(target.handle, tweenDefBuf);
+    this.next = null;
+    tweenObjects.set(this.handle, this);
+    // so that destroying the target destroys its tweens
+    target.hasTweens = true;
+  }
+
+  // stops this tween and the ones that follow it
+  destroy() {
+    for (let tween = this; tween; tween = tween.next) {
+      // a finished tween's handle may have been reused by a newer tween
+      if (tweenObjects.get(tween.handle) !== tween) continue;
+      Diamond.dTween2DDestroyTween(tween.handle);
+      tweenObjects.delete(tween.handle);
+    }
+  }
+
+  // holds next until this tween finishes, then starts it.
+  // returns next, so that sequences can be chained.
+  then(next) {
+    Diamond.dTween2DThen(this.handle, next.handle);
+    this.next = next;
+    return next;
+  }
+}
+
+exports.tween = {
+  // the Tweens that finished in the last frame.
+  // read from native in one call, so read it once per frame.
+  get finished() {
+    let numFinished = Diamond.dTween2DGetFinished(
+      finishedTweensBuf, finishedTweensBuf.length / 4
+    );
+    if (4 * numFinished > finishedTweensBuf.length) {
+      finishedTweensBuf = Buffer.alloc(8 * numFinished);
+      numFinished = Diamond.dTween2DGetFinished(finishedTweensBuf, 2 * numFinished);
+    }
+
+    const finished = [];
+    for (let i = 0; i < numFinished; ++i) {
+      const handle = finishedTweensBuf.readInt32LE(4 * i);
+      const tween = tweenObjects.get(handle);
+      if (tween) {
+        finished.push(tween);
+        tweenObjects.delete(handle);
+      }
+    }
+    return finished;
+  },
+
+  // runs all tweens by delta milliseconds. the game loop does this
+  // each update, so this only needs to be called outside of it.
+  update(delta) {
+    Diamond.dTween2DUpdate(delta);
+  }
+}
+
+
+exports.physics = {
+  // the collisions of the last physics step, each as
+  // {state: 'enter' | 'stay' | 'exit', a: collider, b: collider}.
+  // read from native in one call, so read it once per step.
+  get collisions() {
+    let numEvents = Diamond.dPhysics2DGetCollisionEvents(
+      collisionEventsBuf, collisionEventsBuf.length / COLLISION_EVENT_SIZE
+    );
+    if (numEvents * COLLISION_EVENT_SIZE > collisionEventsBuf.length) {
+      collisionEventsBuf = Buffer.alloc(2 * numEvents * COLLISION_EVENT_SIZE);
+      numEvents = Diamond.dPhysics2DGetCollisionEvents(
+        collisionEventsBuf, collisionEventsBuf.length / COLLISION_EVENT_SIZE
+      );
+    }
+
+    const collisions = [];
+    for (let i = 0; i < numEvents; ++i) {
+      const offset = i * COLLISION_EVENT_SIZE;
+      collisions.push({
+        state: COLLISION_STATES[collisionEventsBuf.readInt32LE(offset)],
+        a: colliderObjects[collisionEventsBuf.readInt32LE(offset + 4)]
+             .get(collisionEventsBuf.readInt32LE(offset + 8)) || null,
+        b: colliderObjects[collisionEventsBuf.readInt32LE(offset + 12)]
+             .get(collisionEventsBuf.readInt32LE(offset + 16)) || null
+      });
+    }
+    return collisions;
+  },
+
+  setLayersCollide(layer1, layer2, collides) {
+    Diamond.dPhysics2DSetLayersCollide(layer1, layer2, collides);
+  },
+
+  // Spatial queries. These see colliders as of the last physics step,
+  // and only find colliders on layers that collide with the given layer
+  // and whose categories have a bit in common with the given mask.
+
+  // returns the closest collider on the line from start to end as
+  // {collider, point, normal, fraction}, or null if there's none.
+  raycast(start, end, layer = 0, mask = MASK_ALL) {
+    queryBuf.writeFloatLE(start.x, 0);
+    queryBuf.writeFloatLE(start.y, 4);
+    queryBuf.writeFloatLE(end.x, 8);
+    queryBuf.writeFloatLE(end.y, 12);
+    queryBuf.writeInt32LE(layer, 16);
+    queryBuf.writeUInt32LE(mask >>> 0, 20);
+    if (!Diamond.dPhysics2DRaycast(queryBuf, raycastHitBuf))
+      return null;
+
+    return {
+      collider: colliderObject(raycastHitBuf, 0),
+      fraction: raycastHitBuf.readFloatLE(8),
+      point: {x: raycastHitBuf.readFloatLE(12), y: raycastHitBuf.readFloatLE(16)},
+      normal: {x: raycastHitBuf.readFloatLE(20), y: raycastHitBuf.readFloatLE(24)}
+    };
+  },
+
+  // casts many rays in one native call, ex. for line of sight checks.
+  // rays holds startX, startY, endX, endY for each ray.
+  // returns a Float32Array with the fraction along each ray
+  // of its closest hit, or -1 where a ray hit nothing.
+  raycastBatch(rays, layer = 0, fractions = new Float32Array(rays.length / 4),
+               mask = MASK_ALL) {
+    const numRays = rays.length / 4;
+    if (raysBuf.length < numRays * RAY_SIZE) {
+      raysBuf = Buffer.alloc(2 * numRays * RAY_SIZE);
+      raycastHitsBuf = Buffer.alloc(2 * numRays * RAYCAST_HIT_SIZE);
+    }
+
+    for (let i = 0; i < numRays; ++i) {
+      const offset = i * RAY_SIZE;
+      raysBuf.writeFloatLE(rays[4 * i], offset);
+      raysBuf.writeFloatLE(rays[4 * i + 1], offset + 4);
+      raysBuf.writeFloatLE(rays[4 * i + 2], offset + 8);
+      raysBuf.writeFloatLE(rays[4 * i + 3], offset + 12);
+      raysBuf.writeInt32LE(layer, offset + 16);
+      raysBuf.writeUInt32LE(mask >>> 0, offset + 20);
+    }
+
+    Diamond.dPhysics2DRaycastBatch(raysBuf, numRays, raycastHitsBuf);
+
+    for (let i = 0; i < numRays; ++i) {
+      const offset = i * RAYCAST_HIT_SIZE;
+      fractions[i] = raycastHitsBuf.readInt32LE(offset) < 0
+        ? -1 : raycastHitsBuf.readFloatLE(offset + 8);
+    }
+    return fractions;
+  },
+
+  // Bulk rigidbody state, to drive many bodies (ex. a flock) in one
+  // native call each. handles is an Int32Array of rigidbody handles
+  // (see Rigidbody2D.handle). velocities and impulses are Float32Arrays
+  // of x, y pairs, one per body, and angular velocities are Float32Arrays
+  // with one per body. the arrays are passed to native without copying.
+  getVelocities(handles, velocities = new Float32Array(2 * handles.length)) {
+    Diamond.dPhysics2DGetVelocities(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(velocities)
+    );
+    return velocities;
+  },
+
+  setVelocities(handles, velocities) {
+    Diamond.dPhysics2DSetVelocities(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(velocities)
+    );
+  },
+
+  getAngularVelocities(handles, angularVelocities = new Float32Array(handles.length)) {
+    Diamond.dPhysics2DGetAngularVelocities(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(angularVelocities)
+    );
+    return angularVelocities;
+  },
+
+  setAngularVelocities(handles, angularVelocities) {
+    Diamond.dPhysics2DSetAngularVelocities(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(angularVelocities)
+    );
+  },
+
+  applyImpulses(handles, impulses) {
+    Diamond.dPhysics2DApplyImpulses(
+      typedArrayBuf(handles), handles.length, typedArrayBuf(impulses)
+    );
+  },
+
+  // returns the colliders that overlap the box from min to max
+  queryAABB(min, max, layer = 0, mask = MASK_ALL) {
+    queryBuf.writeFloatLE(min.x, 0);
+    queryBuf.writeFloatLE(min.y, 4);
+    queryBuf.writeFloatLE(max.x, 8);
+    queryBuf.writeFloatLE(max.y, 12);
+    queryBuf.writeInt32LE(layer, 16);
+    queryBuf.writeUInt32LE(mask >>> 0, 20);
+    return queryColliders(Diamond.dPhysics2DQueryAABB);
+  },
+
+  // returns the colliders that overlap the given circle
+  queryCircle(center, radius, layer = 0, mask = MASK_ALL) {
+    queryBuf.writeFloatLE(center.x, 0);
+    queryBuf.writeFloatLE(center.y, 4);
+    queryBuf.writeFloatLE(radius, 8);
+    queryBuf.writeInt32LE(layer, 12);
+    queryBuf.writeUInt32LE(mask >>> 0, 16);
+    return queryColliders(Diamond.dPhysics2DQueryCircle);
+  },
+
+  // returns the colliders that contain the given point
+  queryPoint(point, layer = 0, mask = MASK_ALL) {
+    queryBuf.writeFloatLE(point.x, 0);
+    queryBuf.writeFloatLE(point.y, 4);
+    queryBuf.writeInt32LE(layer, 8);
+    queryBuf.writeUInt32LE(mask >>> 0, 12);
+    return queryColliders(Diamond.dPhysics2DQueryPoint);
+  },
+
+  // Batched overlap queries, each in one native call.
+  // each returns an array with the array of colliders found by each query.
+
+  // boxes holds minX, minY, maxX, maxY for each box
+  queryAABBBatch(boxes, layer = 0, mask = MASK_ALL) {
+    return queryCollidersBatch(Diamond.dPhysics2DQueryAABBBatch, boxes.length / 4,
+                               AABB_QUERY_SIZE, (offset, i) => {
+      queriesBuf.writeFloatLE(boxes[4 * i], offset);
+      queriesBuf.writeFloatLE(boxes[4 * i + 1], offset + 4);
+      queriesBuf.writeFloatLE(boxes[4 * i + 2], offset + 8);
+      queriesBuf.writeFloatLE(boxes[4 * i + 3], offset + 12);
+      queriesBuf.writeInt32LE(layer, offset + 16);
+      queriesBuf.writeUInt32LE(mask >>> 0, offset + 20);
+    });
+  },
+
+  // circles holds x, y, radius for each circle
+  queryCircleBatch(circles, layer = 0, mask = MASK_ALL) {
+    return queryCollidersBatch(Diamond.dPhysics2DQueryCircleBatch, circles.length / 3,
+                               CIRCLE_QUERY_SIZE, (offset, i) => {
+      queriesBuf.writeFloatLE(circles[3 * i], offset);
+      queriesBuf.writeFloatLE(circles[3 * i + 1], offset + 4);
+      queriesBuf.writeFloatLE(circles[3 * i + 2], offset + 8);
+      queriesBuf.writeInt32LE(layer, offset + 12);
+      queriesBuf.writeUInt32LE(mask >>> 0, offset + 16);
+    });
+  },
+
+  // points holds x, y for each point
+  queryPointBatch(points, layer = 0, mask = MASK_ALL) {
+    return queryCollidersBatch(Diamond.dPhysics2DQueryPointBatch, points.length / 2,
+                               POINT_QUERY_SIZE, (offset, i) => {
+      queriesBuf.writeFloatLE(points[2 * i], offset);
+      queriesBuf.writeFloatLE(points[2 * i + 1], offset + 4);
+      queriesBuf.writeInt32LE(layer, offset + 8);
+      queriesBuf.writeUInt32LE(mask >>> 0, offset + 12);
+    });
+  }
+};
+
 // TODO: add more functionality!
+// type is 'static' for bodies that never move (ex. walls),
+// 'kinematic' or 'dynamic' (the default).
 exports.Rigidbody2D = class Rigidbody2D {
-  constructor(transform) {
-    this.handle = Diamond.dPhysics2DMakeRigidbody(transform.handle);
+  constructor(transform, type = 'dynamic') {
+    const typeIndex = BODY_TYPES.indexOf(type);
+    rigidbodyDefBuf.writeInt32LE(typeIndex < 0 ? BODY_TYPES.indexOf('dynamic') : typeIndex, 0);
+    this.handle = Diamond.dPhysics2DMakeRigidbodyFromDef(transform.handle, rigidbodyDefBuf);
   }
   destroy() {
     Diamond.dPhysics2DDestroyRigidbody(this.handle);
   }
 
+  get type() {
+    return BODY_TYPES[Diamond.dPhysics2DGetRigidbodyType(this.handle)];
+  }
+
+  // call after moving a static body's transform
+  refresh() {
+    Diamond.dPhysics2DRefreshStaticBody(this.handle);
+  }
+
+  // in position units per millisecond.
+  // to drive many bodies, use the bulk functions in physics.
+  get velocity() {
+    rigidbodyHandleBuf.writeInt32LE(this.handle, 0);
+    Diamond.dPhysics2DGetVelocities(rigidbodyHandleBuf, 1, rigidbodyStateBuf);
+    return {x: rigidbodyStateBuf.readFloatLE(0), y: rigidbodyStateBuf.readFloatLE(4)};
+  }
+
+  set velocity(velocity) {
+    rigidbodyHandleBuf.writeInt32LE(this.handle, 0);
+    rigidbodyStateBuf.writeFloatLE(velocity.x, 0);
+    rigidbodyStateBuf.writeFloatLE(velocity.y, 4);
+    Diamond.dPhysics2DSetVelocities(rigidbodyHandleBuf, 1, rigidbodyStateBuf);
+  }
+
+  // in degrees per millisecond
+  get angularVelocity() {
+    rigidbodyHandleBuf.writeInt32LE(this.handle, 0);
+    Diamond.dPhysics2DGetAngularVelocities(rigidbodyHandleBuf, 1, rigidbodyStateBuf);
+    return rigidbodyStateBuf.readFloatLE(0);
+  }
+
+  set angularVelocity(angularVelocity) {
+    rigidbodyHandleBuf.writeInt32LE(this.handle, 0);
+    rigidbodyStateBuf.writeFloatLE(angularVelocity, 0);
+    Diamond.dPhysics2DSetAngularVelocities(rigidbodyHandleBuf, 1, rigidbodyStateBuf);
+  }
+
+  // bodies have no mass, so this adds impulse to the velocity
+  applyImpulse(impulse) {
+    rigidbodyHandleBuf.writeInt32LE(this.handle, 0);
+    rigidbodyStateBuf.writeFloatLE(impulse.x, 0);
+    rigidbodyStateBuf.writeFloatLE(impulse.y, 4);
+    Diamond.dPhysics2DApplyImpulses(rigidbodyHandleBuf, 1, rigidbodyStateBuf);
+  }
+
   get obj() { return {}; }
 
   set(other) {}
 }
 
+// filter is an optional {layer, category, mask}. colliders touch only if
+// their layers collide and each one's category has a bit in its other's mask.
 exports.CircleCollider = class CircleCollider {
-  constructor(rigidbody, circle) {
+  constructor(rigidbody, circle, filter) {
     this.mCircle = circle;
+    initColliderFilter(this, filter);
     this.handle = Diamond.dPhysics2DMakeCircleCollider(
-      rigidbody.handle, circle.center.x, circle.center.y, circle.radius
+      rigidbody.handle, circle.center.x, circle.center.y, circle.radius,
+      writeColliderFilter(this)
     );
+    colliderObjects[COLLIDER_CIRCLE].set(this.handle, this);
   }
   destroy() {
+    colliderObjects[COLLIDER_CIRCLE].delete(this.handle);
     Diamond.dPhysics2DDestroyCircleCollider(this.handle);
   }
 
+  get layer() {
+    return this.mLayer;
+  }
+
+  set layer(layer) {
+    this.mLayer = layer;
+    Diamond.dPhysics2DSetColliderLayer(COLLIDER_CIRCLE, this.handle, layer);
+  }
+
+  get category() {
+    return this.mCategory;
+  }
+
+  set category(category) {
+    this.mCategory = category;
+    Diamond.dPhysics2DSetColliderFilter(COLLIDER_CIRCLE, this.handle, writeColliderFilter(this));
+  }
+
+  get mask() {
+    return this.mMask;
+  }
+
+  set mask(mask) {
+    this.mMask = mask;
+    Diamond.dPhysics2DSetColliderFilter(COLLIDER_CIRCLE, this.handle, writeColliderFilter(this));
+  }
+
   get obj() { return this.circle; }
 
   set(other) {
@@ -633,15 +1767,54 @@ exports.CircleCollider = class CircleCollider {
   }
 }
 
+// filter is as for CircleCollider.
+// points needs at least 3 points, otherwise handle is negative
+// and the collider does nothing.
 exports.PolygonCollider = class PolygonCollider {
-  constructor(rigidbody, points) {
-    this.pointlist = new DPointList(points);
+  constructor(rigidbody, points, filter) {
+    const pointlist = new DPointList(points);
+    this.mPoints = points;
     this.rigidbody = rigidbody;
-    this.handle = Diamond.dPhysics2DMakePolyCollider(rigidbody.handle, this.pointlist.handle);
+    initColliderFilter(this, filter);
+    this.handle = Diamond.dPhysics2DMakePolyCollider(
+      rigidbody.handle, pointlist.handle, writeColliderFilter(this)
+    );
+    pointlist.destroy();
+    if (this.handle >= 0)
+      colliderObjects[COLLIDER_POLY].set(this.handle, this);
   }
   destroy() {
+    if (this.handle < 0)
+      return;
+    colliderObjects[COLLIDER_POLY].delete(this.handle);
     Diamond.dPhysics2DDestroyPolyCollider(this.handle);
-    this.pointlist.destroy();
+  }
+
+  get layer() {
+    return this.mLayer;
+  }
+
+  set layer(layer) {
+    this.mLayer = layer;
+    Diamond.dPhysics2DSetColliderLayer(COLLIDER_POLY, this.handle, layer);
+  }
+
+  get category() {
+    return this.mCategory;
+  }
+
+  set category(category) {
+    this.mCategory = category;
+    Diamond.dPhysics2DSetColliderFilter(COLLIDER_POLY, this.handle, writeColliderFilter(this));
+  }
+
+  get mask() {
+    return this.mMask;
+  }
+
+  set mask(mask) {
+    this.mMask = mask;
+    Diamond.dPhysics2DSetColliderFilter(COLLIDER_POLY, this.handle, writeColliderFilter(this));
   }
 
   get obj() { return this.points; }
@@ -654,13 +1827,22 @@ exports.PolygonCollider = class PolygonCollider {
   }
 
   get points() {
-    return this.pointlist.points;
+    return this.mPoints;
   }
 
+  // reshapes the collider in place, keeping its handle and layer.
+  // less than 3 points are ignored.
   set points(points) {
-    Diamond.dPhysics2DDestroyPolyCollider(this.handle);
-    this.pointlist.points = points;
-    this.handle = Diamond.dPhysics2DMakePolyCollider(this.rigidbody.handle, this.pointlist.handle);
+    if (points.length < 3)
+      return;
+    this.mPoints = points;
+    if (polyPointsBuf.length < 8 * points.length)
+      polyPointsBuf = Buffer.alloc(2 * 8 * points.length);
+    for (let i = 0; i < points.length; ++i) {
+      polyPointsBuf.writeFloatLE(points[i].x, 8 * i);
+      polyPointsBuf.writeFloatLE(points[i].y, 8 * i + 4);
+    }
+    Diamond.dPhysics2DSetPolyColliderPoints(this.handle, polyPointsBuf, points.length);
   }
 }
 
@@ -0,0 +1,198 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_AABBTREE2D_H
+#define D_CD_AABBTREE2D_H
+
+#include <algorithm>
+#include <vector>
+
+struct CDAABB2D {
+    float minX, minY, maxX, maxY;
+
+    bool overlaps(const CDAABB2D& other) const {
+        return minX <= other.maxX && other.minX <= maxX &&
+               minY <= other.maxY && other.minY <= maxY;
+    }
+
+    bool contains(const CDAABB2D& other) const {
+        return minX <= other.minX && minY <= other.minY &&
+               other.maxX <= maxX && other.maxY <= maxY;
+    }
+
+    /**
+     * Whether the ray from (ox, oy) along (dx, dy) enters this box
+     * at a fraction of (dx, dy) between 0 and maxFraction.
+     */
+    bool hitByRay(float ox, float oy, float dx, float dy, float maxFraction) const {
+        float enter = 0, exit = maxFraction;
+        if (dx == 0) {
+            if (ox < minX || ox > maxX) return false;
+        }
+        else {
+            float t0 = (minX - ox) / dx, t1 = (maxX - ox) / dx;
+            enter = std::max(enter, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+        }
+        if (dy == 0) {
+            if (oy < minY || oy > maxY) return false;
+        }
+        else {
+            float t0 = (minY - oy) / dy, t1 = (maxY - oy) / dy;
+            enter = std::max(enter, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+        }
+        return enter <= exit;
+    }
+
+    float perimeter() const {
+        return 2 * ((maxX - minX) + (maxY - minY));
+    }
+
+    static CDAABB2D merge(const CDAABB2D& a, const CDAABB2D& b) {
+        return {std::min(a.minX, b.minX), std::min(a.minY, b.minY),
+                std::max(a.maxX, b.maxX), std::max(a.maxY, b.maxY)};
+    }
+};
+
+/**
+ * A dynamic bounding volume tree for broadphase collision detection.
+ * Each proxy is stored with a fattened AABB, so objects that move
+ * a little don't change the tree. The tree is kept balanced by rotations
+ * as proxies are inserted and removed.
+ * Proxy IDs are reused after proxies are removed.
+ */
+class CDAABBTree2D {
+public:
+    static const int NULL_NODE = -1;
+
+    /**
+     * margin is how much each proxy's AABB is fattened by on every side.
+     */
+    explicit CDAABBTree2D(float margin = 2.0f);
+
+    int insert(const CDAABB2D& aabb, void* userData);
+
+    void remove(int proxy);
+
+    // Removes every proxy, keeping the memory for the next ones.
+    void clear();
+
+    /**
+     * Updates the proxy for an object now bounded by aabb,
+     * which moved by (dx, dy) since it was last updated.
+     * Only changes the tree if aabb left the proxy's fat AABB,
+     * in which case this returns true.
+     */
+    bool move(int proxy, const CDAABB2D& aabb, float dx, float dy);
+
+    const CDAABB2D& getFatAABB(int proxy) const { return nodes[proxy].aabb; }
+
+    void* getUserData(int proxy) const { return nodes[proxy].userData; }
+
+    /**
+     * Calls callback(proxy) for every proxy whose fat AABB overlaps aabb.
+     * Stops early if callback returns false.
+     */
+    template <typename F>
+    void query(const CDAABB2D& aabb, F callback) const {
+        stack.clear();
+        if (root != NULL_NODE) stack.push_back(root);
+
+        while (!stack.empty()) {
+            int id = stack.back();
+            stack.pop_back();
+
+            const Node& node = nodes[id];
+            if (!node.aabb.overlaps(aabb)) continue;
+
+            if (node.isLeaf()) {
+                if (!callback(id)) return;
+            }
+            else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    /**
+     * Calls callback(proxy, maxFraction) for every proxy whose fat AABB
+     * the ray from (ox, oy) along (dx, dy) enters before maxFraction.
+     * callback returns the new maxFraction (ex. the fraction of its hit),
+     * so that proxies past the closest hit so far are skipped.
+     */
+    template <typename F>
+    void raycast(float ox, float oy, float dx, float dy,
+                 float maxFraction, F callback) const {
+        stack.clear();
+        if (root != NULL_NODE) stack.push_back(root);
+
+        while (!stack.empty()) {
+            int id = stack.back();
+            stack.pop_back();
+
+            const Node& node = nodes[id];
+            if (!node.aabb.hitByRay(ox, oy, dx, dy, maxFraction)) continue;
+
+            if (node.isLeaf()) {
+                maxFraction = callback(id, maxFraction);
+            }
+            else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    int getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+private:
+    struct Node {
+        CDAABB2D aabb;
+        void* userData;
+        // next in the free list if the node is free
+        int parent;
+        int child1;
+        int child2;
+        // 0 for leaves, -1 if free
+        int height;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    std::vector<Node> nodes;
+    int root;
+    int freeList;
+    float margin;
+
+    mutable std::vector<int> stack;
+
+    int allocateNode();
+    void freeNode(int id);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+
+    // rotates the subtree at a up if it's unbalanced, returning its new root
+    int balance(int a);
+
+    // refits and rebalances the ancestors of the given node
+    void fixUpwards(int id);
+};
+
+#endif // D_CD_AABBTREE2D_H
@@ -26,6 +26,13 @@ extern "C" {
 // frees all animation associated memory
 CDEXPORT void dAnimation2DDestroyAll();
 
+/**
+ * Loading a sheet with the same sprite sheet texture (or atlas region)
+ * and frames as one that's already loaded returns the same handle,
+ * so call dAnimation2DDestroyAnimationSheet once for every load.
+ * Animators keep the sheets they use loaded, so a sheet can be
+ * destroyed as soon as the animators that use it are made.
+ */
 CDEXPORT tCD_Handle dAnimation2DLoadAnimationSheet(
     tCD_Handle spritesheet, tD_delta frameLength, int numFrames, int rows, int cols
 );
@@ -38,12 +45,43 @@ CDEXPORT tCD_Handle dAnimation2DMakeAnimatorSheet(
 
 CDEXPORT void dAnimation2DDestroyAnimatorSheet(tCD_Handle animatorSheet);
 
-// Sets the given animator's animation to the given animation sheet
+/**
+ * Sets the given animator's animation to the given animation sheet,
+ * starting from its first frame. Plays the animator unless it's paused.
+ */
 CDEXPORT void dAnimation2DSetAnimationSheet(
     tCD_Handle animatorSheet, tCD_Handle animationSheet
 );
 
-// Updates all animations for the current frame
+/**
+ * Animators start out playing. Paused and finished animators
+ * aren't updated at all until they're played again.
+ * Playing a finished animator starts it over, and
+ * stopping an animator pauses it on its first frame.
+ */
+CDEXPORT void dAnimation2DPlay(tCD_Handle animatorSheet);
+CDEXPORT void dAnimation2DPause(tCD_Handle animatorSheet);
+CDEXPORT void dAnimation2DStop(tCD_Handle animatorSheet);
+
+CDEXPORT bool dAnimation2DIsPlaying(tCD_Handle animatorSheet);
+
+/**
+ * Animators loop by default. One that doesn't loop finishes once
+ * its last frame has been on for the frame length, and stays on it.
+ */
+CDEXPORT void dAnimation2DSetLoop(tCD_Handle animatorSheet, bool loop);
+
+/**
+ * Copies up to maxAnimators of the animators that finished in the
+ * last update into animatorSheets, and returns the number that finished.
+ */
+CDEXPORT int dAnimation2DGetFinished(tCD_Handle* animatorSheets, int maxAnimators);
+
+/**
+ * Updates all playing animations for the current frame. Time left over
+ * past the end of a frame counts toward the next one.
+ * A render component's clip is only set when its animator changes frame.
+ */
 CDEXPORT void dAnimation2DUpdate(tD_delta delta);
 
 #ifdef __cplusplus
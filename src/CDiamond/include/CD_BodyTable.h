@@ -0,0 +1,135 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_BODYTABLE_H
+#define D_CD_BODYTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "D_typedefs.h"
+#include "D_Transform2.h"
+#include "CD_ThreadPool.h"
+
+/**
+ * Pairs physics bodies with the transforms they move,
+ * in dense parallel arrays instead of a map.
+ * Bodies are looked up by ID (ex. a physics backend's body ID) in O(1)
+ * and removed by moving the last body into their place,
+ * so syncing bodies and transforms is a straight loop over the arrays.
+ * Given a thread pool, the syncs that touch transforms run in
+ * contiguous ranges of bodies on the pool's threads.
+ * CD_Physics2D keeps one of the bodies made through CDiamond, for
+ * saving, interpolating and restoring transforms around fixed steps.
+ */
+class CDBodyTable {
+public:
+    static const uint32_t NO_INDEX = UINT32_MAX;
+
+    /**
+     * Splits syncs across the given pool's threads (and the calling thread),
+     * in ranges of at least minPerRange bodies, or runs them on the
+     * calling thread only if pool is null (the default).
+     * The pool must outlive the table or be unset first.
+     */
+    void setThreadPool(CDThreadPool* pool, size_t minPerRange);
+
+    /**
+     * Adds a body with the given ID, starting at the given transform.
+     * The ID must not be in the table already.
+     */
+    void add(uint32_t id, Diamond::DTransform2* transform);
+
+    /**
+     * Removes the body with the given ID.
+     * The body that was last takes its index.
+     */
+    void remove(uint32_t id);
+
+    bool contains(uint32_t id) const {
+        return id < indices.size() && indices[id] != NO_INDEX;
+    }
+
+    // Returns the dense index of the body with the given ID.
+    uint32_t indexOf(uint32_t id) const { return indices[id]; }
+
+    size_t size() const { return bodyIDs.size(); }
+
+    // Body state, by dense index.
+    tD_pos* x() { return posX.data(); }
+    tD_pos* y() { return posY.data(); }
+    tD_rot* rotation() { return rot.data(); }
+    const tD_pos* x() const { return posX.data(); }
+    const tD_pos* y() const { return posY.data(); }
+    const tD_rot* rotation() const { return rot.data(); }
+
+    Diamond::DTransform2* const* transforms() const { return transformPtrs.data(); }
+    const uint32_t* ids() const { return bodyIDs.data(); }
+
+    /**
+     * Copies each body's transform into its state (ex. before a physics step).
+     */
+    void pullTransforms();
+
+    /**
+     * Copies each body's state into its transform (ex. after a physics step).
+     */
+    void pushTransforms() const;
+
+    /**
+     * The same copies, for transforms stored as arrays in the same order
+     * as the bodies. These are plain array copies, kept so that the
+     * benchmark can compare them with the copies through transforms.
+     */
+    void pullTransforms(const tD_pos* x, const tD_pos* y, const tD_rot* rotation);
+    void pushTransforms(tD_pos* x, tD_pos* y, tD_rot* rotation) const;
+
+    /**
+     * Interpolation between physics steps.
+     * savePrevious is called before each step, and interpolate
+     * shows each transform between the previous and current state.
+     * Before the next step, restoreTransforms puts the current state
+     * back into the transforms. A transform that was moved since it was
+     * shown was teleported by the game, so its body takes the new value
+     * as both its previous and current state instead.
+     */
+    void savePrevious();
+    void interpolate(float alpha);
+    void restoreTransforms();
+
+private:
+    CDThreadPool* pool = nullptr;
+    size_t minPerRange = 0;
+
+    // calls fn(begin, end) over ranges of bodies that cover them all
+    template <typename F>
+    void forRanges(F fn) const;
+
+    std::vector<tD_pos> posX, posY;
+    std::vector<tD_rot> rot;
+
+    // state before the last step, and what was last shown
+    std::vector<tD_pos> prevX, prevY, shownX, shownY;
+    std::vector<tD_rot> prevRot, shownRot;
+    std::vector<Diamond::DTransform2*> transformPtrs;
+    std::vector<uint32_t> bodyIDs;
+
+    // dense index by ID
+    std::vector<uint32_t> indices;
+};
+
+#endif // D_CD_BODYTABLE_H
@@ -0,0 +1,90 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_BUNDLE_H
+#define D_CD_BUNDLE_H
+
+#include "CD_typedefs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Memory-maps the asset bundle at the given path
+ * (made with the cdbundle tool, see CD_BundleFormat.h).
+ * Returns CD_INVALID_HANDLE if it couldn't be opened or isn't a bundle.
+ */
+CDEXPORT tCD_Handle dBundleOpen(char* path);
+
+/**
+ * Unmaps the given bundle and frees the textures made from it.
+ * Destroy the render components and animation sheets
+ * that use its textures first.
+ */
+CDEXPORT void dBundleClose(tCD_Handle bundle);
+
+CDEXPORT void dBundleCloseAll();
+
+/**
+ * Returns a texture handle for the image or sprite with the given name,
+ * or CD_INVALID_HANDLE if there isn't one.
+ * The texture is made straight from the mapped pixels the first time,
+ * and the same handle is returned afterwards.
+ * The handle belongs to the bundle and is freed when it is closed.
+ * Requires that dRenderer2DInit was called first.
+ */
+CDEXPORT tCD_Handle dBundleLoadTexture(tCD_Handle bundle, char* name);
+
+/**
+ * Makes an animation sheet (see dAnimation2DLoadAnimationSheet)
+ * from the animation with the given name,
+ * or returns CD_INVALID_HANDLE if there isn't one.
+ */
+CDEXPORT tCD_Handle dBundleLoadAnimationSheet(tCD_Handle bundle, char* name);
+
+/**
+ * Writes the definition of the animation with the given name.
+ * Returns false if there isn't one.
+ */
+CDEXPORT bool dBundleGetAnimation(tCD_Handle bundle, char* name,
+                                  tCD_Handle* spritesheet,
+                                  int* frameLength,
+                                  int* numFrames,
+                                  int* rows,
+                                  int* columns);
+
+/**
+ * Makes a config table (see CD_Config.h) from the config with the given name,
+ * or returns CD_INVALID_HANDLE if there isn't one.
+ */
+CDEXPORT tCD_Handle dBundleLoadConfigTable(tCD_Handle bundle, char* name);
+
+/**
+ * Reads the key-value pairs of the config with the given name in place.
+ * dBundleGetConfigSize returns -1 if there isn't one, and the key and value
+ * getters return null if there isn't one or i is out of range.
+ */
+CDEXPORT int dBundleGetConfigSize(tCD_Handle bundle, char* name);
+CDEXPORT const char* dBundleGetConfigKey(tCD_Handle bundle, char* name, int i);
+CDEXPORT const char* dBundleGetConfigValue(tCD_Handle bundle, char* name, int i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // D_CD_BUNDLE_H
@@ -0,0 +1,93 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_BUNDLEFORMAT_H
+#define D_CD_BUNDLEFORMAT_H
+
+#include <stdint.h>
+
+/**
+ * Layout of an asset bundle file, as written by the cdbundle tool
+ * (tools/bundle) and memory-mapped by CD_Bundle.
+ *
+ * A bundle is a header, followed by its entries sorted by name,
+ * with no two entries sharing a name, even if their types differ,
+ * followed by the null-terminated names and strings they refer to,
+ * followed by the entries' data, each starting on a
+ * CD_BUNDLE_DATA_ALIGN byte boundary, followed by a null byte.
+ * All offsets are from the start of the file and all values
+ * are little-endian, so that everything can be used in place.
+ */
+
+#define CD_BUNDLE_MAGIC       "CDBN"
+#define CD_BUNDLE_VERSION     1
+#define CD_BUNDLE_DATA_ALIGN  16
+
+// Entry types
+#define CD_BUNDLE_IMAGE     0   // RGBA32 pixels, width * 4 bytes per row
+#define CD_BUNDLE_SPRITE    1   // a region of an image (ex. an atlas page)
+#define CD_BUNDLE_CONFIG    2   // dBundleConfigPair array
+#define CD_BUNDLE_ANIMATION 3   // an animation sheet of an image or sprite
+
+typedef struct {
+    char     magic[4];
+    uint32_t version;
+    uint32_t numEntries;
+    uint32_t entriesOffset;
+} dBundleHeader;
+
+typedef struct {
+    int32_t width;
+    int32_t height;
+} dBundleImage;
+
+typedef struct {
+    int32_t image; // entry index
+    int32_t x, y, w, h;
+} dBundleSprite;
+
+typedef struct {
+    int32_t numPairs;
+} dBundleConfig;
+
+typedef struct {
+    uint32_t keyOffset;
+    uint32_t valueOffset;
+} dBundleConfigPair;
+
+typedef struct {
+    int32_t spritesheet; // entry index of an image or sprite
+    int32_t frameLength;
+    int32_t numFrames;
+    int32_t rows;
+    int32_t columns;
+} dBundleAnimation;
+
+typedef struct {
+    uint32_t nameOffset;
+    uint32_t type;
+    uint32_t dataOffset;
+    uint32_t dataSize;
+    union {
+        dBundleImage     image;
+        dBundleSprite    sprite;
+        dBundleConfig    config;
+        dBundleAnimation animation;
+    };
+} dBundleEntry;
+
+#endif // D_CD_BUNDLEFORMAT_H
@@ -0,0 +1,254 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef D_CD_ECSWORLD_H
+#define D_CD_ECSWORLD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "CD_typedefs.h"
+
+/**
+ * Component type ids range from 0 to CD_ECS_MAX_COMPONENTS - 1.
+ * CD_ECS_MAX_COMPONENTS itself is the id of types that didn't get one,
+ * and no entity can have components of that type.
+ */
+#define CD_ECS_MAX_COMPONENTS 63
+
+typedef uint32_t tCD_ComponentType;
+typedef uint64_t tCD_ComponentMask;
+
+/**
+ * Returns a new component type id, shared by all worlds,
+ * or CD_ECS_MAX_COMPONENTS once all ids are taken.
+ */
+tCD_ComponentType cdNewComponentType();
+
+// The id of component type T, made the first time it's asked for.
+template <typename T>
+tCD_ComponentType cdComponentType() {
+    static const tCD_ComponentType type = cdNewComponentType();
+    return type;
+}
+
+// The mask with the bits of all of Ts set.
+template <typename... Ts>
+tCD_ComponentMask cdComponentMask() {
+    tCD_ComponentMask mask = 0;
+    int expand[] = {0, (mask |= (tCD_ComponentMask)1 << cdComponentType<Ts>(), 0)...};
+    (void)expand;
+    return mask;
+}
+
+/**
+ * Entities and their components, stored by archetype, as an alternative
+ * to Diamond::Entity's map of component names to virtual components.
+ * An archetype is a set of component types. All entities with exactly
+ * that set are kept in it, with one array per component type holding
+ * their components in the same order. Looking up a component is
+ * two array lookups, and iterating over all entities with some
+ * component types is a linear scan of each matching archetype's arrays.
+ *
+ * Components are plain data: they're copied with memcpy when
+ * their entity changes archetype, and aren't constructed or destroyed.
+ * Adding or removing a component moves its entity to another archetype,
+ * so component pointers are only valid until the next time an entity
+ * is made or destroyed or a component is added or removed.
+ */
+class CDECSWorld {
+public:
+    static const uint32_t NO_ARCHETYPE = UINT32_MAX;
+
+    CDECSWorld();
+
+    CDECSWorld(const CDECSWorld&) = delete;
+    CDECSWorld& operator=(const CDECSWorld&) = delete;
+
+    // Makes an entity with no components.
+    tCD_Handle makeEntity();
+    void destroyEntity(tCD_Handle entity);
+
+    bool contains(tCD_Handle entity) const {
+        return entity >= 0 && (size_t)entity < entityArchetypes.size() &&
+               entityArchetypes[entity] != NO_ARCHETYPE;
+    }
+
+    /**
+     * Sets the size in bytes of components of the given type, which
+     * is needed before adding them with addComponent. The first size
+     * set for a type stays. The typed functions set it themselves.
+     */
+    void setComponentSize(tCD_ComponentType type, size_t size);
+
+    /**
+     * Gives the entity a component of the given type with a copy of
+     * the bytes in data, or zeroed if data is null, replacing any
+     * component of that type it had. Returns the component, or null
+     * if the entity doesn't exist or the type has no size.
+     */
+    void* addComponent(tCD_Handle entity, tCD_ComponentType type, const void* data);
+
+    // Returns whether the entity had a component of that type.
+    bool removeComponent(tCD_Handle entity, tCD_ComponentType type);
+
+    // null if the entity doesn't have a component of that type
+    void* getComponent(tCD_Handle entity, tCD_ComponentType type);
+
+    // 0 if the entity doesn't exist
+    tCD_ComponentMask getComponentMask(tCD_Handle entity) const {
+        return contains(entity) ? archetypes[entityArchetypes[entity]].mask : 0;
+    }
+
+    template <typename T>
+    T* add(tCD_Handle entity, const T& component = T());
+
+    template <typename T>
+    bool remove(tCD_Handle entity) {
+        return removeComponent(entity, cdComponentType<T>());
+    }
+
+    template <typename T>
+    T* get(tCD_Handle entity) {
+        return static_cast<T*>(getComponent(entity, cdComponentType<T>()));
+    }
+
+    template <typename... Ts>
+    bool has(tCD_Handle entity) const {
+        tCD_ComponentMask mask = cdComponentMask<Ts...>();
+        return contains(entity) && (getComponentMask(entity) & mask) == mask;
+    }
+
+    /**
+     * Calls fn(count, entities, arrays...) for each archetype that has
+     * count > 0 entities with all of Ts, where entities holds their handles
+     * and there's one array of count components for each of Ts.
+     * fn mustn't make or destroy entities or add or remove components.
+     */
+    template <typename... Ts, typename F>
+    void eachArchetype(F fn);
+
+    /**
+     * Calls fn(entity, components...) for each entity with all of Ts,
+     * with a reference to each of its components of those types.
+     * The same restrictions as eachArchetype apply.
+     */
+    template <typename... Ts, typename F>
+    void each(F fn);
+
+    size_t size() const { return entityArchetypes.size() - freeHandles.size(); }
+
+    size_t numArchetypes() const { return archetypes.size(); }
+
+private:
+    struct Archetype {
+        tCD_ComponentMask mask;
+        std::vector<tCD_ComponentType> types;
+        // by type, the index of the type's array in columns, or -1
+        int8_t columnOf[CD_ECS_MAX_COMPONENTS];
+        // each holds entities.size() components of the type with the same index
+        std::vector<std::vector<unsigned char> > columns;
+        std::vector<tCD_Handle> entities;
+        // by type, the archetype with that type added or removed,
+        // or -1 if it hasn't been looked up yet
+        int32_t addEdges[CD_ECS_MAX_COMPONENTS];
+        int32_t removeEdges[CD_ECS_MAX_COMPONENTS];
+    };
+
+    std::vector<Archetype> archetypes;
+    std::unordered_map<tCD_ComponentMask, uint32_t> archetypeIndices;
+    // by type, 0 if not set yet
+    std::vector<size_t> componentSizes;
+
+    // By handle.
+    std::vector<uint32_t> entityArchetypes;
+    std::vector<uint32_t> rows;
+    std::vector<tCD_Handle> freeHandles;
+
+    uint32_t findArchetype(tCD_ComponentMask mask);
+    void moveEntity(tCD_Handle entity, uint32_t to);
+    void removeRow(Archetype& archetype, uint32_t row);
+};
+
+/**
+ * An entity in a world, with an interface like Diamond::Entity's
+ * but with components looked up by type instead of by name.
+ * Doesn't own the entity, so it's copied around like a handle.
+ */
+class CDEntity {
+public:
+    // makes a new entity in the world
+    explicit CDEntity(CDECSWorld& world)
+        : world(&world), handle(world.makeEntity()) {}
+
+    CDEntity(CDECSWorld& world, tCD_Handle handle)
+        : world(&world), handle(handle) {}
+
+    void destroy() { world->destroyEntity(handle); }
+
+    template <typename T>
+    T* addComponent(const T& component = T()) { return world->add<T>(handle, component); }
+
+    template <typename T>
+    bool removeComponent() { return world->remove<T>(handle); }
+
+    template <typename T>
+    T* getComponent() const { return world->get<T>(handle); }
+
+    tCD_Handle getHandle() const { return handle; }
+
+private:
+    CDECSWorld* world;
+    tCD_Handle handle;
+};
+
+
+template <typename T>
+T* CDECSWorld::add(tCD_Handle entity, const T& component) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "components are copied with memcpy");
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "component arrays are only aligned to max_align_t");
+    tCD_ComponentType type = cdComponentType<T>();
+    setComponentSize(type, sizeof(T));
+    return static_cast<T*>(addComponent(entity, type, &component));
+}
+
+template <typename... Ts, typename F>
+void CDECSWorld::eachArchetype(F fn) {
+    tCD_ComponentMask mask = cdComponentMask<Ts...>();
+    for (auto& archetype : archetypes) {
+        if ((archetype.mask & mask) != mask || archetype.entities.empty())
+            continue;
+        fn(archetype.entities.size(), archetype.entities.data(),
+           reinterpret_cast<Ts*>(
+               archetype.columns[archetype.columnOf[cdComponentType<Ts>()]].data()
+           )...);
+    }
+}
+
+template <typename... Ts, typename F>
+void CDECSWorld::each(F fn) {
+    eachArchetype<Ts...>([&fn](size_t count, const tCD_Handle* entities, Ts*... arrays) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(entities[i], arrays[i]...);
+        }
+    });
+}
+
+#endif // D_CD_ECSWORLD_H
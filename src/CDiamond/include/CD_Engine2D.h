@@ -20,6 +20,10 @@
 #include "D_Engine2D.h"
 #include "CD_typedefs.h"
 
+// Physics backends
+#define CD_PHYSICS_QUANTUM 0 // the engine's own Quantum2D world
+#define CD_PHYSICS_NATIVE  1 // CDNativeWorld2D
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,6 +43,37 @@ CDEXPORT void dEngine2DConfigureAudio(int numChannels,
                                       int frequency,
                                       int sampleSize);
 
+/**
+ * fixedStep is the length in milliseconds of each physics step
+ * (whole milliseconds, as the physics world takes),
+ * or 0 to step physics once per frame by the frame's delta (the default).
+ * With a fixed step, physics takes as many steps each frame as fit in the
+ * time that has passed, up to maxSubsteps (time beyond that is dropped),
+ * and if interpolate is true, transforms are shown interpolated between
+ * the last two physics steps.
+ */
+CDEXPORT void dEngine2DConfigurePhysics(tD_delta fixedStep,
+                                        int maxSubsteps,
+                                        bool interpolate);
+
+/**
+ * Selects the physics world implementation (CD_PHYSICS_*)
+ * that the engine is initialized with. Defaults to CD_PHYSICS_QUANTUM.
+ */
+CDEXPORT void dEngine2DConfigurePhysicsBackend(int backend);
+
+/**
+ * numThreads is how many threads, counting the game loop's own,
+ * the per-step syncing of rigidbodies and their transforms is split
+ * across (along with moving bodies and colliders, in the native
+ * physics world, and updating nodes, if dNode2DInit was called before
+ * the physics was initialized). Defaults to 1, ie. no extra threads.
+ * Work is only split once there are at least minBodiesPerThread bodies
+ * per thread, as handing off fewer costs more than it saves.
+ */
+CDEXPORT void dEngine2DConfigurePhysicsThreads(int numThreads,
+                                               int minBodiesPerThread);
+
 /**
  * Initializes the game engine and all subsystems.
  * configure_ functions should be called before this
@@ -71,4 +106,38 @@ CDEXPORT void dEngine2DQuitGame();
 
 Diamond::Engine2D* dEngine2DGetEngine();
 
+struct SDL_Renderer;
+
+/**
+ * The SDL renderer of the window that the engine made,
+ * or nullptr if the engine wasn't made or doesn't render with SDL.
+ */
+SDL_Renderer* dEngine2DGetSDLRenderer();
+
+struct CDPhysicsConfig2D {
+    tD_delta fixedStep = 0;
+    int maxSubsteps = 8;
+    bool interpolate = true;
+    int numThreads = 1;
+    int minBodiesPerThread = 4096;
+};
+
+const CDPhysicsConfig2D& dEngine2DGetPhysicsConfig();
+
+/**
+ * Replaces the renderer used by the engine's game loop
+ * and returns the renderer that was replaced.
+ * The engine does not take ownership of the given renderer,
+ * and restores its own renderer when it is destroyed.
+ */
+Diamond::Renderer2D* dEngine2DSwapRenderer(Diamond::Renderer2D* renderer);
+
+/**
+ * Replaces the physics world used by the engine's game loop
+ * and returns the physics world that was replaced.
+ * Like dEngine2DSwapRenderer, the engine does not take ownership
+ * of the given physics world.
+ */
+Diamond::PhysicsWorld2D* dEngine2DSwapPhysWorld(Diamond::PhysicsWorld2D* physWorld);
+
 #endif // D_CD_ENGINE2D_H
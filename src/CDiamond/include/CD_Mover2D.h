@@ -0,0 +1,71 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef D_CD_MOVER2D_H
+#define D_CD_MOVER2D_H
+
+#include "D_typedefs.h"
+#include "CD_typedefs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// frees all movers
+CDEXPORT void dMover2DDestroyAll();
+
+/**
+ * Makes a mover at rest for each of count transforms,
+ * and copies their handles into movers.
+ * Movers move their transforms by their velocities each frame,
+ * without a rigidbody, ex. for bullets and decorations.
+ * Destroy a transform's mover before destroying the transform.
+ */
+CDEXPORT void dMover2DMakeMovers(const tCD_Handle* transforms, int count,
+                                 tCD_Handle* movers);
+CDEXPORT void dMover2DDestroyMovers(const tCD_Handle* movers, int count);
+
+/**
+ * Bulk mover state, for count movers at a time.
+ * Linear velocities and accelerations are x, y pairs, one per mover,
+ * in position units per millisecond (per millisecond). Angular velocities
+ * and accelerations are in degrees per millisecond (per millisecond).
+ */
+CDEXPORT void dMover2DGetVelocities(const tCD_Handle* movers, int count,
+                                    tD_pos* velocities);
+CDEXPORT void dMover2DSetVelocities(const tCD_Handle* movers, int count,
+                                    const tD_pos* velocities);
+CDEXPORT void dMover2DGetAngularVelocities(const tCD_Handle* movers, int count,
+                                           float* angularVelocities);
+CDEXPORT void dMover2DSetAngularVelocities(const tCD_Handle* movers, int count,
+                                           const float* angularVelocities);
+CDEXPORT void dMover2DSetAccelerations(const tCD_Handle* movers, int count,
+                                       const tD_pos* accelerations);
+CDEXPORT void dMover2DSetAngularAccelerations(const tCD_Handle* movers, int count,
+                                              const float* angularAccelerations);
+
+/**
+ * Accelerates all movers and then moves their transforms.
+ * Called by the game before tweens and nodes (see CD_Systems2D),
+ * so tweens and parents override movers.
+ */
+CDEXPORT void dMover2DUpdate(tD_delta delta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // D_CD_MOVER2D_H
@@ -0,0 +1,363 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_NATIVEWORLD2D_H
+#define D_CD_NATIVEWORLD2D_H
+
+#include <bitset>
+#include <utility>
+#include <vector>
+#include "duMemPool.h"
+#include "D_PhysicsWorld2D.h"
+#include "D_Transform2.h"
+#include "CD_AABBTree2D.h"
+#include "CD_Physics2D.h"
+#include "CD_ThreadPool.h"
+
+class CDNativeWorld2D;
+
+class CDNativeBody2D : public Diamond::Rigidbody2D {
+public:
+    CDNativeBody2D(Diamond::DTransform2* transform, int type)
+        : transform(transform), type(type), velocity(0, 0), angVelocity(0) {}
+
+    int getType() const { return type; }
+
+    Diamond::Vector2<tD_pos> getVelocity() const override { return velocity; }
+    void setVelocity(const Diamond::Vector2<tD_pos>& newvel) override { velocity = newvel; }
+
+    float getAngularVelocity() const override { return angVelocity; }
+    void setAngularVelocity(float newVel) override { angVelocity = newVel; }
+
+private:
+    friend class CDNativeWorld2D;
+
+    Diamond::DTransform2* transform;
+    int type;
+    Diamond::Vector2<tD_pos> velocity;
+    float angVelocity;
+    // in the world's list of moving bodies
+    size_t index;
+};
+
+/**
+ * What the native world knows of a collider of any type:
+ * its shape in the body's space and in world space.
+ */
+struct CDNativeShape2D {
+    int type;
+    Diamond::CollisionLayer layer;
+    // see dColliderFilter2D
+    uint32_t category;
+    uint32_t mask;
+    const CDNativeBody2D* body;
+    // CD_BODY_*, static if there's no body
+    int bodyType;
+    void* parent;
+    std::function<void(void* other)> onCollision;
+
+    // in body space
+    Diamond::Vector2<tD_pos> origin; // AABB min or circle center
+    Diamond::Vector2<tD_pos> dims;   // AABB dims
+    tD_pos radius;
+    Diamond::PointList2D points;
+
+    // in world space, as of the last step or change
+    CDAABB2D bounds;
+    Diamond::Vector2<tD_pos> worldCenter;
+    tD_pos worldRadius;
+    Diamond::PointList2D worldPoints;
+
+    int proxy;
+    // in the world's list of moving or static shapes
+    size_t index;
+};
+
+class CDNativeAABBCollider2D : public Diamond::AABBCollider2D {
+public:
+    CDNativeAABBCollider2D(CDNativeWorld2D* world) : world(world) {}
+
+    Diamond::CollisionLayer getLayer() const override { return shape.layer; }
+    void setLayer(Diamond::CollisionLayer layer) override;
+
+    void setColFunc(const std::function<void(void* other)>& onCollision) override {
+        shape.onCollision = onCollision;
+    }
+
+    Diamond::Vector2<tD_pos> getOrigin() const override { return shape.origin; }
+    Diamond::Vector2<tD_pos> getDims() const override { return shape.dims; }
+
+    Diamond::Vector2<tD_pos> getMin() const override {
+        return Diamond::Vector2<tD_pos>(shape.bounds.minX, shape.bounds.minY);
+    }
+    Diamond::Vector2<tD_pos> getMax() const override {
+        return Diamond::Vector2<tD_pos>(shape.bounds.maxX, shape.bounds.maxY);
+    }
+
+    void setOrigin(const Diamond::Vector2<tD_pos>& origin) override;
+    void setDims(const Diamond::Vector2<tD_pos>& dims) override;
+
+    CDNativeShape2D shape;
+
+private:
+    CDNativeWorld2D* world;
+};
+
+class CDNativeCircleCollider : public Diamond::CircleCollider {
+public:
+    CDNativeCircleCollider(CDNativeWorld2D* world) : world(world) {}
+
+    Diamond::CollisionLayer getLayer() const override { return shape.layer; }
+    void setLayer(Diamond::CollisionLayer layer) override;
+
+    void setColFunc(const std::function<void(void* other)>& onCollision) override {
+        shape.onCollision = onCollision;
+    }
+
+    tD_pos getRadius() const override { return shape.radius; }
+    tD_pos getRadiusSq() const override { return shape.radius * shape.radius; }
+    tD_pos getWorldRadius() const override { return shape.worldRadius; }
+
+    Diamond::Vector2<tD_pos> getCenter() const override { return shape.origin; }
+    Diamond::Vector2<tD_pos> getWorldPos() const override { return shape.worldCenter; }
+
+    void setRadius(tD_pos radius) override;
+    void setCenter(const Diamond::Vector2<tD_pos>& center) override;
+
+    CDNativeShape2D shape;
+
+private:
+    CDNativeWorld2D* world;
+};
+
+class CDNativePolyCollider : public Diamond::PolyCollider {
+public:
+    CDNativePolyCollider(CDNativeWorld2D* world) : world(world) {}
+
+    Diamond::CollisionLayer getLayer() const override { return shape.layer; }
+    void setLayer(Diamond::CollisionLayer layer) override;
+
+    void setColFunc(const std::function<void(void* other)>& onCollision) override {
+        shape.onCollision = onCollision;
+    }
+
+    Diamond::PointList2D points() const override { return shape.points; }
+    Diamond::PointList2D worldPoints() const override { return shape.worldPoints; }
+
+    // Copies the world points into out, which only allocates
+    // if out has less capacity than there are points.
+    void worldPoints(Diamond::PointList2D& out) const {
+        out.assign(shape.worldPoints.begin(), shape.worldPoints.end());
+    }
+
+    // Replaces the vertices with count points from xy, given as x, y pairs.
+    // Less than 3 points are ignored.
+    void setPoints(const tD_pos* xy, size_t count);
+
+    CDNativeShape2D shape;
+
+private:
+    CDNativeWorld2D* world;
+};
+
+/**
+ * A physics world implemented in CDiamond, as an alternative to
+ * the engine's Quantum2D world (see dEngine2DConfigurePhysicsBackend).
+ * Behaves like the Quantum2D world: bodies move their transforms
+ * by their velocities (per millisecond), colliders take on their body's
+ * position, rotation (degrees) and scale, and the onCollision functions
+ * of both colliders are called with each other's parent every step
+ * that they touch. Collisions aren't resolved.
+ *
+ * Static bodies and their colliders are left out of each step's
+ * integration and shape updates, and pairs where both colliders
+ * are on static bodies aren't tested.
+ * Pairs whose layers don't collide or whose categories and masks
+ * don't match are dropped in the broadphase, before any shape tests.
+ *
+ * Candidate pairs come from a dynamic AABB tree and are kept between
+ * steps until their fat AABBs stop overlapping, so only colliders that
+ * moved out of their fat AABB are looked up in the tree each step.
+ * Polygons are tested with the separating axis theorem,
+ * and must be convex.
+ *
+ * Given a thread pool, integration and shape updates run in contiguous
+ * ranges of bodies and colliders on the pool's threads. The tree and
+ * the pairs are updated on the calling thread.
+ */
+class CDNativeWorld2D : public Diamond::PhysicsWorld2D {
+public:
+    /**
+     * Like the engine's own physics world, bodies and colliders
+     * must be freed before the world is destroyed.
+     */
+    CDNativeWorld2D();
+
+    bool init(const Diamond::Config& config) override;
+
+    void setLayersCollide(Diamond::CollisionLayer layer1,
+                          Diamond::CollisionLayer layer2,
+                          bool collides) override;
+
+    bool doLayersCollide(Diamond::CollisionLayer layer1,
+                         Diamond::CollisionLayer layer2) const override {
+        return layerMatrix[layer1][layer2];
+    }
+
+    void allLayersCollideOn() override;
+    void allLayersCollideOff() override;
+
+    void update(tD_delta delta_ms) override;
+
+    // makes a dynamic body
+    Diamond::DumbPtr<Diamond::Rigidbody2D> makeRigidbody(Diamond::DTransform2& transform) override;
+
+    Diamond::DumbPtr<Diamond::Rigidbody2D> makeRigidbody(Diamond::DTransform2& transform,
+                                                         const CDRigidbodyDef2D& def);
+
+    Diamond::DumbPtr<Diamond::AABBCollider2D> makeAABBCollider(
+        const Diamond::Rigidbody2D* body,
+        void* parent,
+        const std::function<void(void* other)>& onCollision,
+        const Diamond::Vector2<tD_pos>& dims,
+        const Diamond::Vector2<tD_pos>& origin = Diamond::Vector2<tD_pos>(0, 0),
+        Diamond::CollisionLayer layer = 0) override;
+
+    Diamond::DumbPtr<Diamond::CircleCollider> makeCircleCollider(
+        const Diamond::Rigidbody2D* body,
+        void* parent,
+        const std::function<void(void* other)>& onCollision,
+        tD_pos radius,
+        const Diamond::Vector2<tD_pos>& center = Diamond::Vector2<tD_pos>(0, 0),
+        Diamond::CollisionLayer layer = 0) override;
+
+    Diamond::DumbPtr<Diamond::PolyCollider> makePolyCollider(
+        const Diamond::Rigidbody2D* body,
+        void* parent,
+        const std::function<void(void* other)>& onCollision,
+        const Diamond::PointList2D& points,
+        Diamond::CollisionLayer layer = 0) override;
+
+    // Recomputes a collider's world shape after its shape was changed.
+    void refresh(CDNativeShape2D& shape);
+
+    // Sets the layer, category and mask that a collider's pairs are filtered by.
+    void setFilter(CDNativeShape2D& shape, Diamond::CollisionLayer layer,
+                   uint32_t category, uint32_t mask);
+
+    // Recomputes the world shapes of a static body's colliders
+    // after its transform was moved.
+    void refreshBody(const Diamond::Rigidbody2D* body);
+
+    /**
+     * Splits each step's integration and shape updates across the given
+     * pool's threads (and the calling thread), in ranges of at least
+     * minPerRange bodies or colliders, or runs them on the calling
+     * thread only if pool is null (the default).
+     * The pool must outlive the world or be unset first.
+     */
+    void setThreadPool(CDThreadPool* pool, size_t minPerRange);
+
+    // bodies that move, ie. that aren't static
+    size_t numMovingBodies() const { return bodies.size(); }
+    size_t numColliders() const { return shapes.size() + staticShapes.size(); }
+    // candidate pairs from the broadphase as of the last step
+    size_t numPairs() const { return pairs.size(); }
+
+    // the broadphase tree, with each proxy's CDNativeShape2D as its user data
+    const CDAABBTree2D& getTree() const { return tree; }
+
+private:
+    class BodyDeleter : public Diamond::DumbDeleter {
+    public:
+        BodyDeleter(CDNativeWorld2D& world) : world(world) {}
+        void free(void* body) const override;
+    private:
+        CDNativeWorld2D& world;
+    };
+
+    // Base is the type that the pointers being freed were handed out as
+    template <typename Collider, typename Base>
+    class ColliderDeleter : public Diamond::DumbDeleter {
+    public:
+        ColliderDeleter(CDNativeWorld2D& world, Diamond::MemPool<Collider>& pool)
+            : world(world), pool(pool) {}
+        void free(void* collider) const override {
+            auto ptr = static_cast<Collider*>(static_cast<Base*>(collider));
+            world.removeShape(ptr->shape);
+            pool.free(ptr);
+        }
+    private:
+        CDNativeWorld2D& world;
+        Diamond::MemPool<Collider>& pool;
+    };
+
+    std::bitset<256> layerMatrix[256];
+
+    Diamond::MemPool<CDNativeBody2D> bodyPool;
+    Diamond::MemPool<CDNativeAABBCollider2D> aabbPool;
+    Diamond::MemPool<CDNativeCircleCollider> circlePool;
+    Diamond::MemPool<CDNativePolyCollider> polyPool;
+
+    BodyDeleter bodyDeleter;
+    ColliderDeleter<CDNativeAABBCollider2D, Diamond::AABBCollider2D> aabbDeleter;
+    ColliderDeleter<CDNativeCircleCollider, Diamond::CircleCollider> circleDeleter;
+    ColliderDeleter<CDNativePolyCollider, Diamond::PolyCollider> polyDeleter;
+
+    // bodies and shapes that move
+    std::vector<CDNativeBody2D*> bodies;
+    std::vector<CDNativeShape2D*> shapes;
+    std::vector<CDNativeShape2D*> staticShapes;
+
+    CDAABBTree2D tree;
+    // proxies whose fat AABBs changed since the last step
+    std::vector<int> movedProxies;
+    // candidate pairs of proxies, lower proxy first, sorted
+    std::vector<std::pair<int, int> > pairs;
+    std::vector<std::pair<int, int> > newPairs;
+    // set when filters changed, so that pairs that no longer pass are dropped
+    bool refilterPairs = false;
+    // set when the layer matrix changed, so that every pair is looked up again
+    bool refilterAll = false;
+
+    CDThreadPool* pool = nullptr;
+    size_t minPerRange = 0;
+    // shapes' bounds from before the step's shape updates, by shape index
+    std::vector<CDAABB2D> oldBounds;
+
+    // calls fn(begin, end) over ranges that cover [0, count)
+    template <typename F>
+    void forRanges(size_t count, F fn);
+
+    void initShape(CDNativeShape2D& shape, int type, const Diamond::Rigidbody2D* body,
+                   void* parent, const std::function<void(void* other)>& onCollision,
+                   Diamond::CollisionLayer layer);
+    void updateWorldShape(CDNativeShape2D& shape);
+    void addShape(CDNativeShape2D& shape);
+    void removeShape(CDNativeShape2D& shape);
+    void destroyBody(CDNativeBody2D* body);
+
+    // whether a and b pass each other's filters
+    bool filtersPass(const CDNativeShape2D& a, const CDNativeShape2D& b) const {
+        return layerMatrix[a.layer][b.layer] &&
+               (a.category & b.mask) && (b.category & a.mask);
+    }
+
+    void updatePairs();
+};
+
+#endif // D_CD_NATIVEWORLD2D_H
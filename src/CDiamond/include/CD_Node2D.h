@@ -0,0 +1,92 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef D_CD_NODE2D_H
+#define D_CD_NODE2D_H
+
+#include <cstddef>
+#include "CD_typedefs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Transform parenting. A node is bound to a transform (see CD_Transform2),
+ * which is its world transform, and has a local transform in its parent's
+ * space. See CDNodeTree2D for how the hierarchy is updated.
+ */
+
+CDEXPORT bool dNode2DInit();
+CDEXPORT void dNode2DDestroy();
+
+// Makes a root node for the given transform, which must outlive the node.
+CDEXPORT tCD_Handle dNode2DMakeNode(tCD_Handle transform);
+
+// The node's children become roots, keeping their world transforms.
+CDEXPORT void dNode2DDestroyNode(tCD_Handle node);
+
+/**
+ * Makes child a child of parent, keeping its world transform.
+ * Returns false if parent is child or one of its descendants.
+ */
+CDEXPORT bool dNode2DAddChild(tCD_Handle parent, tCD_Handle child);
+
+// Returns false if child isn't a child of parent.
+CDEXPORT bool dNode2DRemoveChild(tCD_Handle parent, tCD_Handle child);
+
+// CD_INVALID_HANDLE for roots
+CDEXPORT tCD_Handle dNode2DGetParent(tCD_Handle node);
+
+CDEXPORT dTransform2f dNode2DGetLocalTransform(tCD_Handle node);
+
+CDEXPORT void dNode2DSetLocalTransform(tCD_Handle node,
+                                       float positionX, float positionY,
+                                       float rotation,
+                                       float scaleX, float scaleY);
+
+/**
+ * Convert count points, given as x, y pairs, between the node's space
+ * and world space as of the last update. in and out may be the same array.
+ */
+CDEXPORT void dNode2DLocalToWorldPoints(tCD_Handle node, const float* in,
+                                        float* out, int count);
+CDEXPORT void dNode2DWorldToLocalPoints(tCD_Handle node, const float* in,
+                                        float* out, int count);
+
+/**
+ * Takes in transforms that were moved since the last update, and moves
+ * the subtrees of nodes that moved or whose local transforms were set.
+ * The game calls this after its update (as one of the systems in
+ * CD_Systems2D) and again after each physics step,
+ * so this only needs to be called to see the results of moves sooner.
+ * Does nothing if dNode2DInit wasn't called.
+ */
+CDEXPORT void dNode2DUpdate();
+
+#ifdef __cplusplus
+}
+#endif
+
+class CDNodeTree2D;
+class CDThreadPool;
+
+CDNodeTree2D& dNode2DGetTree();
+
+// See CDNodeTree2D::setThreadPool. Does nothing if dNode2DInit wasn't called.
+void dNode2DSetThreadPool(CDThreadPool* pool, size_t minPerRange);
+
+#endif // D_CD_NODE2D_H
@@ -0,0 +1,153 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef D_CD_NODETREE2D_H
+#define D_CD_NODETREE2D_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "duMatrix.h"
+#include "D_typedefs.h"
+#include "D_Transform2.h"
+#include "CD_typedefs.h"
+
+class CDThreadPool;
+
+/**
+ * A transform hierarchy stored flat, as an alternative to Diamond::Node2D's
+ * tree of pointers. Each node is bound to a world transform and keeps
+ * a local transform in its parent's space. Nodes are kept in arrays with
+ * every parent before its children, so updating the hierarchy is a linear
+ * sweep, and dirty flags carried down from parents to children mean that
+ * only subtrees that changed are recomputed.
+ *
+ * Like Node2D, call update() after changing local transforms and again
+ * after anything else (ex. physics) moves world transforms. A node whose
+ * world transform was moved from outside since the last update takes it
+ * as its new local transform in its parent's space as of the last update,
+ * so children carried along by a moving parent stay attached.
+ * A local transform set since the last update wins over such a move.
+ *
+ * Given a thread pool, taking in outside moves runs in contiguous ranges
+ * of nodes, and recomputing world transforms in ranges of whole root
+ * subtrees, on the pool's threads.
+ */
+class CDNodeTree2D {
+public:
+    static const uint32_t NO_SLOT = UINT32_MAX;
+
+    /**
+     * Makes a root node bound to the given world transform,
+     * with a local transform equal to it. The transform must outlive the node.
+     */
+    tCD_Handle makeNode(Diamond::DTransform2* transform);
+
+    // The node's children become roots, and keep their world transforms.
+    void destroyNode(tCD_Handle node);
+
+    /**
+     * Makes child a child of parent, removing it from its previous parent.
+     * Like Node2D::addChild, the child keeps its world transform, and its
+     * local transform becomes that in the parent's space.
+     * Returns false without changing anything if parent is child
+     * or one of its descendants.
+     */
+    bool addChild(tCD_Handle parent, tCD_Handle child);
+
+    /**
+     * Makes child a root if it's a child of parent,
+     * keeping its world transform. Returns whether it was.
+     */
+    bool removeChild(tCD_Handle parent, tCD_Handle child);
+
+    bool contains(tCD_Handle node) const {
+        return node >= 0 && (size_t)node < slots.size() && slots[node] != NO_SLOT;
+    }
+
+    // CD_INVALID_HANDLE for roots
+    tCD_Handle getParent(tCD_Handle node) const { return parents[node]; }
+
+    const Diamond::DTransform2& getLocalTransform(tCD_Handle node) const;
+
+    // Moves the node, and its subtree, at the next update.
+    void setLocalTransform(tCD_Handle node, const Diamond::DTransform2& local);
+
+    /**
+     * Converts count points between the node's space and world space,
+     * as of the last update. in and out may be the same array.
+     */
+    void localToWorldSpace(tCD_Handle node, const Diamond::Vector2<tD_pos>* in,
+                           Diamond::Vector2<tD_pos>* out, size_t count) const;
+    void worldToLocalSpace(tCD_Handle node, const Diamond::Vector2<tD_pos>* in,
+                           Diamond::Vector2<tD_pos>* out, size_t count) const;
+
+    /**
+     * Takes in world transforms that were moved from outside,
+     * then recomputes the world transforms of the nodes whose local
+     * transforms or ancestors changed.
+     */
+    void update();
+
+    /**
+     * Splits updates across the given pool's threads (and the calling
+     * thread), in ranges of at least minPerRange nodes, or runs them on
+     * the calling thread only if pool is null (the default).
+     * The pool must outlive the tree or be unset first.
+     */
+    void setThreadPool(CDThreadPool* pool, size_t minPerRange);
+
+    size_t size() const { return slots.size() - freeHandles.size(); }
+
+private:
+    typedef Diamond::Matrix<tD_real, 2, 2> Mat2;
+
+    // By slot, every parent before its children.
+    // A destroyed node's slot has a null transform until the order is rebuilt.
+    std::vector<Diamond::DTransform2*> transforms;
+    std::vector<int32_t> parentSlots; // -1 for roots
+    std::vector<Diamond::DTransform2> locals;
+    // world transforms and their matrices as of the last update,
+    // with inverses for converting into the nodes' spaces
+    std::vector<Diamond::DTransform2> cachedWorlds;
+    std::vector<Mat2> mats;
+    std::vector<Mat2> invMats;
+    std::vector<uint8_t> dirty;
+    std::vector<tCD_Handle> slotNodes;
+
+    // By handle.
+    std::vector<uint32_t> slots;
+    std::vector<tCD_Handle> parents;
+    std::vector<std::vector<tCD_Handle> > children;
+    std::vector<tCD_Handle> freeHandles;
+
+    // set when parents may no longer come before their children
+    bool orderDirty = false;
+    // cleared when a subtree may no longer come right after its root,
+    // which splitting updates by root subtree relies on
+    bool subtreesContiguous = true;
+
+    CDThreadPool* pool = nullptr;
+    size_t minPerRange = 0;
+
+    void detach(tCD_Handle child);
+    void rebuildOrder();
+
+    template <typename F>
+    void forRanges(size_t count, F fn);
+};
+
+#endif // D_CD_NODETREE2D_H
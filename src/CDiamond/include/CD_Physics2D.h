@@ -17,9 +17,60 @@
 #ifndef D_CD_PHYSICS2D_H
 #define D_CD_PHYSICS2D_H
 
+#include <vector>
 #include "CD_typedefs.h"
 #include "D_PhysicsWorld2D.h"
 
+// Collider types
+#define CD_COLLIDER_AABB   0
+#define CD_COLLIDER_CIRCLE 1
+#define CD_COLLIDER_POLY   2
+#define CD_NUM_COLLIDER_TYPES 3
+
+// Rigidbody types
+#define CD_BODY_STATIC    0 // never moves, ex. walls and level geometry
+#define CD_BODY_KINEMATIC 1 // moved only by its velocity or by setting its transform
+#define CD_BODY_DYNAMIC   2 // moved by the simulation (the default)
+
+// Collider filter defaults
+#define CD_CATEGORY_DEFAULT 0x00000001u
+#define CD_MASK_ALL         0xFFFFFFFFu
+
+// Collision event states
+#define CD_COLLISION_ENTER 0 // started touching this physics step
+#define CD_COLLISION_STAY  1 // touching this step and the one before
+#define CD_COLLISION_EXIT  2 // stopped touching this physics step
+
+/**
+ * A pair of colliders that touched (or stopped touching)
+ * during the last physics step. Each pair is reported once,
+ * with the collider made first as A.
+ */
+typedef struct {
+    int        state;
+    int        typeA;
+    tCD_Handle colliderA;
+    int        typeB;
+    tCD_Handle colliderB;
+} dCollisionEvent2D;
+
+typedef struct {
+    int type; // CD_BODY_*
+} dRigidbodyDef2D;
+
+/**
+ * Decides which colliders a collider can touch.
+ * Two colliders touch only if their layers collide
+ * (see dPhysics2DSetLayersCollide) and each one's category
+ * has a bit in common with the other's mask.
+ * ex. bullets with category 2 and mask ~2u never touch each other.
+ */
+typedef struct {
+    int      layer;    // 0 to 255, 0 by default
+    uint32_t category; // the bits this collider is, CD_CATEGORY_DEFAULT by default
+    uint32_t mask;     // the categories this collider touches, CD_MASK_ALL by default
+} dColliderFilter2D;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -32,12 +83,52 @@ CDEXPORT bool dPhysics2DInit();
 
 CDEXPORT void dPhysics2DDestroy();
 
+// makes a dynamic rigidbody
 CDEXPORT tCD_Handle dPhysics2DMakeRigidbody(tCD_Handle transform);
+
+/**
+ * Static bodies are left out of the transform syncing and interpolation
+ * done each step, and pairs of colliders that are both on static bodies
+ * aren't tested against each other by the native physics world
+ * (see dEngine2DConfigurePhysicsBackend). To move a static body,
+ * ex. to place level geometry, set its transform and then
+ * call dPhysics2DRefreshStaticBody.
+ */
+CDEXPORT tCD_Handle dPhysics2DMakeRigidbodyFromDef(tCD_Handle transform,
+                                                   const dRigidbodyDef2D* def);
 CDEXPORT void dPhysics2DDestroyRigidbody(tCD_Handle rigidbody);
 
-// TODO: take callback function pointers for collisions
+CDEXPORT int dPhysics2DGetRigidbodyType(tCD_Handle rigidbody);
+
+// updates the colliders of a static body whose transform was moved
+CDEXPORT void dPhysics2DRefreshStaticBody(tCD_Handle rigidbody);
+
+/**
+ * Bulk rigidbody state, for count rigidbodies at a time.
+ * Linear velocities and impulses are x, y pairs, one per rigidbody,
+ * in position units per millisecond. Angular velocities are
+ * in degrees per millisecond.
+ */
+CDEXPORT void dPhysics2DGetVelocities(const tCD_Handle* bodies, int count,
+                                      tD_pos* velocities);
+CDEXPORT void dPhysics2DSetVelocities(const tCD_Handle* bodies, int count,
+                                      const tD_pos* velocities);
+CDEXPORT void dPhysics2DGetAngularVelocities(const tCD_Handle* bodies, int count,
+                                             float* angularVelocities);
+CDEXPORT void dPhysics2DSetAngularVelocities(const tCD_Handle* bodies, int count,
+                                             const float* angularVelocities);
+
+/**
+ * Adds each impulse to its rigidbody's velocity.
+ * Bodies have no mass, so an impulse is a change in velocity.
+ */
+CDEXPORT void dPhysics2DApplyImpulses(const tCD_Handle* bodies, int count,
+                                      const tD_pos* impulses);
+
+// filter may be null for the default filter
 CDEXPORT tCD_Handle dPhysics2DMakeAABBCollider(
-    tCD_Handle rigidbody, tD_pos originX, tD_pos originY, tD_pos dimX, tD_pos dimY
+    tCD_Handle rigidbody, tD_pos originX, tD_pos originY, tD_pos dimX, tD_pos dimY,
+    const dColliderFilter2D* filter
 );
 CDEXPORT void dPhysics2DDestroyAABBCollider(tCD_Handle aabb);
 
@@ -46,7 +137,8 @@ CDEXPORT void dPhysics2DSetAABBCollider(
 );
 
 CDEXPORT tCD_Handle dPhysics2DMakeCircleCollider(
-    tCD_Handle rigidbody, tD_pos centerX, tD_pos centerY, tD_pos radius
+    tCD_Handle rigidbody, tD_pos centerX, tD_pos centerY, tD_pos radius,
+    const dColliderFilter2D* filter
 );
 CDEXPORT void dPhysics2DDestroyCircleCollider(tCD_Handle circle);
 
@@ -54,16 +146,104 @@ CDEXPORT void dPhysics2DSetCircleCollider(
     tCD_Handle circle, tD_pos centerX, tD_pos centerY, tD_pos radius
 );
 
-// construct points using functions in CD_Util
+/**
+ * Construct points using functions in CD_Util.
+ * Returns CD_INVALID_HANDLE if there are less than 3 points.
+ */
 CDEXPORT tCD_Handle dPhysics2DMakePolyCollider(
-    tCD_Handle rigidbody, tCD_Handle points
+    tCD_Handle rigidbody, tCD_Handle points, const dColliderFilter2D* filter
 );
 CDEXPORT void dPhysics2DDestroyPolyCollider(tCD_Handle poly);
 
+/**
+ * Replaces the polygon's vertices with count points from xy,
+ * given as x, y pairs in the rigidbody's local space.
+ * The collider keeps its handle and layer.
+ * Less than 3 points are ignored, leaving the polygon as it was.
+ */
+CDEXPORT void dPhysics2DSetPolyColliderPoints(tCD_Handle poly, const tD_pos* xy, int count);
+
+/**
+ * Copies up to maxPoints of the polygon's vertices in world space
+ * into xy as x, y pairs, and returns the total number of vertices.
+ */
+CDEXPORT int dPhysics2DGetPolyColliderWorldPoints(tCD_Handle poly, tD_pos* xy, int maxPoints);
+
+/**
+ * Sets the layer of the collider of the given type (CD_COLLIDER_*).
+ * Colliders start out on layer 0. Layers range from 0 to 255.
+ */
+CDEXPORT void dPhysics2DSetColliderLayer(int type, tCD_Handle collider, int layer);
+
+CDEXPORT void dPhysics2DSetLayersCollide(int layer1, int layer2, bool collides);
+
+/**
+ * Sets the layer, category and mask of the collider of the given type.
+ * With the native physics world, pairs that don't pass each other's
+ * filters are dropped before any shape tests. With Quantum2D,
+ * categories and masks only filter collision events.
+ */
+CDEXPORT void dPhysics2DSetColliderFilter(int type, tCD_Handle collider,
+                                          const dColliderFilter2D* filter);
+
+/**
+ * Copies up to maxEvents collision events of the last physics step
+ * into events, and returns the total number of events of that step.
+ * Events stay available until the next physics step, so call this
+ * again with a bigger buffer if the returned number is bigger than maxEvents.
+ * Colliders destroyed since the last step are not reported as exiting.
+ */
+CDEXPORT int dPhysics2DGetCollisionEvents(dCollisionEvent2D* events, int maxEvents);
+
 #ifdef __cplusplus
 }
 #endif
 
+class CDNativeWorld2D;
+
+struct CDRigidbodyDef2D : public Diamond::RigidbodyDef2D {
+    int type = CD_BODY_DYNAMIC;
+};
+
+/**
+ * What a collider's parent pointer refers to, so that collision callbacks
+ * can tell which colliders touched.
+ * Stays at the same address for as long as its collider exists.
+ */
+struct CDCollider2D {
+    int type;
+    tCD_Handle handle;
+    // never reused, unlike handles
+    uint32_t id;
+    uint32_t category;
+    uint32_t mask;
+};
+
+/**
+ * The records of the colliders of the given type, indexed by handle.
+ * Null where there's no collider with that handle.
+ */
+const std::vector<CDCollider2D*> &dPhysics2DGetColliderRecords(int type);
+
+/**
+ * Copies the polygon's vertices in world space into out. With the native
+ * physics world, this only allocates if out has less capacity than
+ * there are vertices.
+ */
+void dPhysics2DGetPolyWorldPoints(tCD_Handle poly, Diamond::PointList2D& out);
+
+Diamond::Collider2D *dPhysics2DGetCollider(int type, tCD_Handle collider);
+
+/**
+ * Changes whenever colliders may have moved, been made or destroyed,
+ * or changed shape or layer, so that anything derived from them
+ * knows when to update.
+ */
+uint32_t dPhysics2DGetVersion();
+
+// The native physics world, or nullptr if the physics world is Quantum2D's.
+CDNativeWorld2D* dPhysics2DGetNativeWorld();
+
 Diamond::DumbPtr<Diamond::Rigidbody2D> &dPhysics2DGetRigidbody(tCD_Handle rigidbody);
 Diamond::DumbPtr<Diamond::AABBCollider2D> &dPhysics2DGetAABBCollider(tCD_Handle aabb);
 Diamond::DumbPtr<Diamond::CircleCollider> &dPhysics2DGetCircleCollider(tCD_Handle circle);
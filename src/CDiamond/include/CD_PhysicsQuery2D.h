@@ -0,0 +1,135 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_PHYSICSQUERY2D_H
+#define D_CD_PHYSICSQUERY2D_H
+
+#include <stdint.h>
+#include "CD_typedefs.h"
+
+/**
+ * Spatial queries against the colliders of the physics world.
+ * Queries see colliders where they were as of the last physics update
+ * (or collider change), so transforms moved since then aren't taken
+ * into account until the next update.
+ *
+ * Every query has a layer, and only finds colliders on layers
+ * that collide with it (see dPhysics2DSetLayersCollide).
+ * Every query also has a mask, and only finds colliders whose
+ * category has a bit in common with it (CD_MASK_ALL finds any).
+ * Queries run through a bounding volume tree of the colliders,
+ * so they only test the colliders near them: the native physics
+ * world's own broadphase tree, or with Quantum2D a tree that the first
+ * query after each physics step refits for the colliders that moved.
+ * Poly colliders are treated as convex.
+ */
+
+typedef struct {
+    float    startX, startY;
+    float    endX, endY;
+    int      layer;
+    uint32_t mask;
+} dRay2D;
+
+/**
+ * The closest collider that a ray hit.
+ * type is -1 if the ray hit nothing.
+ * fraction is how far along the ray the hit is, from 0 at its start
+ * to 1 at its end. A ray that starts inside a collider hits it
+ * at fraction 0, with a zero normal.
+ */
+typedef struct {
+    int        type;
+    tCD_Handle collider;
+    float      fraction;
+    float      x, y;
+    float      normalX, normalY;
+} dRaycastHit2D;
+
+typedef struct {
+    float    minX, minY;
+    float    maxX, maxY;
+    int      layer;
+    uint32_t mask;
+} dAABBQuery2D;
+
+typedef struct {
+    float    x, y;
+    float    radius;
+    int      layer;
+    uint32_t mask;
+} dCircleQuery2D;
+
+typedef struct {
+    float    x, y;
+    int      layer;
+    uint32_t mask;
+} dPointQuery2D;
+
+typedef struct {
+    int        type;
+    tCD_Handle collider;
+} dColliderRef2D;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Finds the closest collider that the ray from start to end hits.
+ * Returns whether it hit anything.
+ */
+CDEXPORT bool dPhysics2DRaycast(const dRay2D* ray, dRaycastHit2D* hit);
+
+/**
+ * Casts numRays rays, writing the hit of each ray to hits[i].
+ * Returns the number of rays that hit something.
+ */
+CDEXPORT int dPhysics2DRaycastBatch(const dRay2D* rays, int numRays, dRaycastHit2D* hits);
+
+/**
+ * The overlap queries below write up to maxResults of the colliders
+ * they find into results, and return the number of colliders found,
+ * which may be more than maxResults.
+ */
+CDEXPORT int dPhysics2DQueryAABB(const dAABBQuery2D* query,
+                                 dColliderRef2D* results, int maxResults);
+CDEXPORT int dPhysics2DQueryCircle(const dCircleQuery2D* query,
+                                   dColliderRef2D* results, int maxResults);
+CDEXPORT int dPhysics2DQueryPoint(const dPointQuery2D* query,
+                                  dColliderRef2D* results, int maxResults);
+
+/**
+ * The batched overlap queries run numQueries queries and write
+ * their results one after another into results, with counts[i]
+ * being the number of results written for query i.
+ * Stops writing results once maxResults have been written,
+ * in which case the counts of the remaining queries are 0.
+ * Returns the total number of results written.
+ */
+CDEXPORT int dPhysics2DQueryAABBBatch(const dAABBQuery2D* queries, int numQueries,
+                                      dColliderRef2D* results, int maxResults, int* counts);
+CDEXPORT int dPhysics2DQueryCircleBatch(const dCircleQuery2D* queries, int numQueries,
+                                        dColliderRef2D* results, int maxResults, int* counts);
+CDEXPORT int dPhysics2DQueryPointBatch(const dPointQuery2D* queries, int numQueries,
+                                       dColliderRef2D* results, int maxResults, int* counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // D_CD_PHYSICSQUERY2D_H
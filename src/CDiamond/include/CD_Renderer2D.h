@@ -17,12 +17,61 @@
 #ifndef D_CD_RENDERER2D_H
 #define D_CD_RENDERER2D_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "D_Renderer2D.h"
 #include "D_TextureFactory.h"
 #include "CD_typedefs.h"
 
 typedef int tCD_RenderLayer;
 
+#define CD_RENDER_STATS_MAX_LAYERS 32
+
+// Texture load states, see dRenderer2DLoadTextureAsync
+#define CD_TEXTURE_LOADING 0
+#define CD_TEXTURE_LOADED  1
+#define CD_TEXTURE_FAILED  2
+
+/**
+ * Counters for the most recently rendered frame.
+ * Draw calls, texture switches and color/alpha mod changes are
+ * estimates, not counters read from SDL: they are worked out from
+ * the visible render components of each layer in the order the SDL
+ * renderer keeps them in, assuming it draws each layer in that order.
+ * A component is culled if it has no sprite or is fully transparent.
+ * Layers past CD_RENDER_STATS_MAX_LAYERS are only counted in objects.
+ */
+typedef struct {
+    int   numLayers;
+    int   objectsPerLayer[CD_RENDER_STATS_MAX_LAYERS];
+    int   objects;
+    int   drawCalls;       // estimate
+    int   textureSwitches; // estimate
+    int   colorModChanges; // estimate
+    int   alphaModChanges; // estimate
+    int   culled;
+    int   pointsQueued;
+    int   linesQueued;
+    float renderTimeMs; // wall time spent in the renderer's renderAll
+} dRenderStats2D;
+
+/**
+ * Memory used by textures loaded from files.
+ * Bytes are width x height x bytes per pixel of each texture.
+ * Unreferenced textures (no handles or render components use them)
+ * stay cached until the total goes over the budget.
+ */
+typedef struct {
+    int64_t bytes;
+    int64_t referencedBytes;
+    int64_t budget;
+    int     numTextures;
+    int     numReferenced;
+    int     hits;       // loads of paths that were already cached
+    int     misses;
+    int     evictions;  // unreferenced textures freed to fit the budget
+} dTextureMemoryStats2D;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -38,13 +87,70 @@ CDEXPORT void dRenderer2DDestroy();
 CDEXPORT void dRenderer2DGetResolution(int* x, int* y);
 CDEXPORT void dRenderer2DGetScreenResolution(int* x, int* y);
 
+/**
+ * Copies the render statistics of the last rendered frame into stats.
+ */
+CDEXPORT void dRenderer2DGetStats(dRenderStats2D* stats);
+
 /**
  * Returns CD_INVALID_HANDLE if texture failed to load.
+ * Loading a path that is already loaded returns a new handle
+ * to the same texture.
  */
 CDEXPORT tCD_Handle dRenderer2DLoadTexture(char* path);
 
+/**
+ * Starts loading the given texture and returns its handle right away.
+ * The image is decoded on a worker thread and uploaded to the renderer
+ * by dRenderer2DUpdateTextureLoads on the main thread,
+ * so the handle can't be drawn with until its state is CD_TEXTURE_LOADED.
+ * If the texture fails to load, its handle is freed
+ * once its state becomes CD_TEXTURE_FAILED.
+ */
+CDEXPORT tCD_Handle dRenderer2DLoadTextureAsync(char* path);
+
+/**
+ * Returns the load state of the given texture.
+ * Textures loaded with dRenderer2DLoadTexture are always CD_TEXTURE_LOADED.
+ * Handles that failed to load, were destroyed or were never made are
+ * CD_TEXTURE_FAILED, until a later load reuses them.
+ */
+CDEXPORT int dRenderer2DGetTextureState(tCD_Handle texture);
+
+/**
+ * Uploads the textures that finished decoding since the last call.
+ * Call this once per frame on the thread that owns the renderer.
+ */
+CDEXPORT void dRenderer2DUpdateTextureLoads();
+
+/**
+ * Writes up to maxLoads textures whose asynchronous loads have finished
+ * (uploaded or failed) since the last poll into textures, along with their
+ * states into states, and returns how many were written.
+ * Loads that didn't fit are returned by the next poll.
+ */
+CDEXPORT int dRenderer2DPollTextureLoads(tCD_Handle* textures,
+                                         int* states,
+                                         int maxLoads);
+
+/**
+ * Frees the given texture.
+ * Does nothing for sprites packed into an atlas page-
+ * those are freed along with their atlas.
+ * A texture that is still loading is freed when its load finishes,
+ * and is not returned by dRenderer2DPollTextureLoads.
+ */
 CDEXPORT void dRenderer2DDestroyTexture(tCD_Handle texture);
 
+/**
+ * Sets how many bytes of texture memory may be used before
+ * unreferenced textures are freed, least recently used first.
+ * Defaults to 256 MB.
+ */
+CDEXPORT void dRenderer2DSetTextureBudget(size_t bytes);
+
+CDEXPORT void dRenderer2DGetTextureMemoryStats(dTextureMemoryStats2D* stats);
+
 CDEXPORT tCD_Handle dRenderer2DMakeRenderComponent(tCD_Handle transform,
                                                    tCD_Handle texture,
                                                    tCD_RenderLayer layer);
@@ -79,11 +185,50 @@ CDEXPORT bool dRenderComponent2DIsFlippedY(tCD_Handle renderComponent);
 }
 #endif
 
+struct SDL_Renderer;
+
+/**
+ * The texture that a texture handle refers to, and the region of it
+ * that is drawn (the whole texture, unless the handle refers to a sprite
+ * packed into an atlas page, in which case the page is shared
+ * and not owned by the handle).
+ */
+struct CDTexture2D {
+    Diamond::DumbPtr<Diamond::Texture> texture;
+    bool isRegion;
+    int x, y, w, h;
+};
+
 Diamond::Renderer2D* dRenderer2DGetRenderer();
 
+/**
+ * The SDL renderer behind the engine's renderer,
+ * for making textures that don't come from image files.
+ */
+SDL_Renderer* dRenderer2DGetSDLRenderer();
+
 Diamond::DumbPtr<Diamond::Texture>&
 dRenderer2DGetTexture(tCD_Handle texture);
 
+const CDTexture2D& dRenderer2DGetTextureRegion(tCD_Handle texture);
+
+/**
+ * Makes a texture handle for the given region of a texture
+ * that is owned elsewhere (ex. by an atlas).
+ */
+tCD_Handle dRenderer2DMakeTextureRegion(const Diamond::DumbPtr<Diamond::Texture>& texture,
+                                        int x, int y, int w, int h);
+
+void dRenderer2DDestroyTextureRegion(tCD_Handle texture);
+
+/**
+ * Adds or removes a reference to a texture loaded from a file,
+ * keeping it alive while the caller uses it.
+ * Returns false and does nothing for other textures (ex. atlas pages).
+ */
+bool dRenderer2DRetainTexture(const Diamond::Texture* texture);
+bool dRenderer2DReleaseTexture(const Diamond::Texture* texture);
+
 Diamond::DumbPtr<Diamond::RenderComponent2D>&
 dRenderComponent2DGetRenderComponent(tCD_Handle renderComponent);
 
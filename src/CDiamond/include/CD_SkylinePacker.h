@@ -0,0 +1,68 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_SKYLINEPACKER_H
+#define D_CD_SKYLINEPACKER_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Packs rectangles into a fixed size area, such as an atlas page.
+ * Keeps track of the skyline formed by the bottom edges of the
+ * rectangles packed so far, and places each new rectangle on the
+ * skyline where its bottom edge ends up highest (bottom-left heuristic).
+ * Coordinates start at the top left of the area.
+ * Packing rectangles in order of decreasing height works best.
+ */
+class CDSkylinePacker {
+public:
+    CDSkylinePacker(int width, int height);
+
+    /**
+     * Finds a place for a w x h rectangle, reserves it,
+     * and returns its top left corner in x and y.
+     * Returns false if the rectangle doesn't fit.
+     */
+    bool insert(int w, int h, int& x, int& y);
+
+    /**
+     * The size of the smallest area that contains
+     * every rectangle packed so far.
+     */
+    int usedWidth() const { return maxX; }
+    int usedHeight() const { return maxY; }
+
+private:
+    struct Segment {
+        int x, y, width;
+    };
+
+    int width, height;
+    int maxX, maxY;
+    std::vector<Segment> skyline;
+
+    /**
+     * Returns the y at which a w x h rectangle starting at
+     * segment i would rest, or -1 if it doesn't fit there.
+     */
+    int fit(size_t i, int w, int h) const;
+
+    void place(size_t i, int x, int y, int w, int h);
+};
+
+#endif // D_CD_SKYLINEPACKER_H
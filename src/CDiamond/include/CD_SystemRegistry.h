@@ -0,0 +1,91 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef D_CD_SYSTEMREGISTRY_H
+#define D_CD_SYSTEMREGISTRY_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "D_typedefs.h"
+#include "CD_ECSWorld.h"
+#include "CD_typedefs.h"
+
+/**
+ * Systems updated once a frame in a fixed order, each one a single
+ * non-virtual call that goes over all of its objects, instead of a
+ * virtual Component::update call per object. The time each system
+ * takes is recorded on every update.
+ */
+class CDSystemRegistry {
+public:
+    typedef std::function<void(tD_delta)> UpdateFunc;
+
+    /**
+     * Adds a system that calls fn each update. Systems run in increasing
+     * order, and systems with the same order run in the order they were added.
+     * Returns a handle for removing the system.
+     */
+    tCD_Handle addSystem(const std::string& name, int order, UpdateFunc fn);
+
+    /**
+     * Adds a system that calls T::updateAll(T* components, size_t count, delta)
+     * for each of the world's arrays of components of type T.
+     * The world must outlive the system.
+     */
+    template <typename T>
+    tCD_Handle addComponentSystem(const std::string& name, int order, CDECSWorld& world);
+
+    void removeSystem(tCD_Handle system);
+
+    // Runs every system in order, and records how long each one takes.
+    void update(tD_delta delta);
+
+    // Systems by index, in the order they run.
+
+    size_t size() const { return systems.size(); }
+
+    const std::string& getName(size_t index) const { return systems[index].name; }
+
+    // how long the system took in the last update, in milliseconds
+    float getTimeMs(size_t index) const { return systems[index].timeMs; }
+
+private:
+    struct System {
+        tCD_Handle handle;
+        std::string name;
+        int order;
+        UpdateFunc update;
+        float timeMs;
+    };
+
+    std::vector<System> systems;
+    tCD_Handle nextHandle = 0;
+};
+
+
+template <typename T>
+tCD_Handle CDSystemRegistry::addComponentSystem(const std::string& name, int order,
+                                                CDECSWorld& world) {
+    return addSystem(name, order, [&world](tD_delta delta) {
+        world.eachArchetype<T>([delta](size_t count, const tCD_Handle*,
+                                       T* components) {
+            T::updateAll(components, count, delta);
+        });
+    });
+}
+
+#endif // D_CD_SYSTEMREGISTRY_H
@@ -0,0 +1,67 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef D_CD_SYSTEMS2D_H
+#define D_CD_SYSTEMS2D_H
+
+#include "D_typedefs.h"
+#include "CD_typedefs.h"
+
+// Orders of the built-in systems (see CDSystemRegistry::addSystem)
+#define CD_SYSTEM_ORDER_MOVERS    50
+#define CD_SYSTEM_ORDER_TWEENS    100
+#define CD_SYSTEM_ORDER_NODES     200 // moves children along with what update moved
+#define CD_SYSTEM_ORDER_ANIMATION 300
+#define CD_SYSTEM_ORDER_PARTICLES 400
+
+#define CD_SYSTEM_NAME_SIZE 32
+
+typedef struct {
+    char  name[CD_SYSTEM_NAME_SIZE]; // null-terminated, cut short if too long
+    float timeMs; // wall time spent in the system's last update
+} dSystemTiming2D;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Sets up the registry of systems that the game updates each frame,
+ * right after the game's update function and before physics,
+ * with the built-in systems (movers, tweens, nodes, animation and particles) in it.
+ */
+CDEXPORT bool dSystems2DInit();
+CDEXPORT void dSystems2DDestroy();
+
+// Runs every system in order. Does nothing if dSystems2DInit wasn't called.
+CDEXPORT void dSystems2DUpdate(tD_delta delta);
+
+/**
+ * Copies up to maxTimings of the systems' timings of the last update,
+ * in the order they ran, into timings, and returns the number of systems.
+ */
+CDEXPORT int dSystems2DGetTimings(dSystemTiming2D* timings, int maxTimings);
+
+#ifdef __cplusplus
+}
+#endif
+
+class CDSystemRegistry;
+
+// for adding native systems
+CDSystemRegistry& dSystems2DGetRegistry();
+
+#endif // D_CD_SYSTEMS2D_H
@@ -0,0 +1,57 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_TEXTUREATLAS2D_H
+#define D_CD_TEXTUREATLAS2D_H
+
+#include "CD_typedefs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Packs the images at the given paths into atlas pages of at most
+ * pageSize x pageSize pixels, so that sprites that share a page
+ * can be drawn without switching textures.
+ * A texture handle for each image is written to textures, in the same
+ * order as paths, or CD_INVALID_HANDLE if the image failed to load
+ * or is bigger than a page. These handles can be used anywhere
+ * a texture handle from dRenderer2DLoadTexture can,
+ * and are freed along with the atlas.
+ * Returns CD_INVALID_HANDLE if no images could be packed.
+ * Requires that dRenderer2DInit was called first.
+ */
+CDEXPORT tCD_Handle dTextureAtlas2DLoad(char** paths,
+                                        int numPaths,
+                                        int pageSize,
+                                        tCD_Handle* textures);
+
+CDEXPORT int dTextureAtlas2DGetNumPages(tCD_Handle atlas);
+
+/**
+ * Frees the given atlas' pages and the texture handles of its sprites.
+ */
+CDEXPORT void dTextureAtlas2DDestroy(tCD_Handle atlas);
+
+CDEXPORT void dTextureAtlas2DDestroyAll();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // D_CD_TEXTUREATLAS2D_H
@@ -0,0 +1,115 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_TEXTURECACHE_H
+#define D_CD_TEXTURECACHE_H
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "D_Texture.h"
+
+/**
+ * Owns textures loaded from files, identified by path,
+ * and counts the references to each of them.
+ * A texture that is no longer referenced stays cached so that loading
+ * its path again is free, until the memory used by all cached textures
+ * goes over the budget. Then the least recently released
+ * unreferenced textures are freed first.
+ * Referenced textures are never freed, even when over budget.
+ */
+class CDTextureCache {
+public:
+    explicit CDTextureCache(size_t budget);
+
+    /**
+     * Frees every cached texture, referenced or not.
+     */
+    ~CDTextureCache();
+
+    CDTextureCache(const CDTextureCache&) = delete;
+    CDTextureCache& operator=(const CDTextureCache&) = delete;
+
+    /**
+     * Returns the texture cached for the given path after adding
+     * a reference to it, or nullptr if the path isn't cached.
+     */
+    Diamond::Texture* acquire(const std::string& path);
+
+    /**
+     * Like acquire, but not counted as a hit or miss,
+     * for loads that were already counted when they started.
+     */
+    Diamond::Texture* acquireUncounted(const std::string& path);
+
+    /**
+     * Caches a newly made texture that takes up the given number of bytes
+     * under the given path, with one reference.
+     * The cache takes ownership of the texture.
+     * The path must not be cached already.
+     */
+    void insert(const std::string& path, Diamond::Texture* texture, size_t bytes);
+
+    /**
+     * Adds or removes a reference to the given texture.
+     * Does nothing and returns false if the texture isn't owned by this cache.
+     */
+    bool retain(const Diamond::Texture* texture);
+    bool release(const Diamond::Texture* texture);
+
+    size_t budget() const { return maxBytes; }
+
+    /**
+     * Frees unreferenced textures until the cache fits the new budget.
+     */
+    void setBudget(size_t budget);
+
+    size_t numTextures() const { return entries.size(); }
+    size_t numReferenced() const { return entries.size() - unreferenced.size(); }
+
+    size_t bytes() const { return totalBytes; }
+    size_t referencedBytes() const { return totalBytes - unreferencedBytes; }
+
+    // Loads that found their path cached or not, and textures freed to fit the budget
+    size_t hits() const { return numHits; }
+    size_t misses() const { return numMisses; }
+    size_t evictions() const { return numEvictions; }
+
+private:
+    struct Entry {
+        std::string path;
+        size_t bytes;
+        int refs;
+        // position in unreferenced while refs is 0
+        std::list<const Diamond::Texture*>::iterator lruPos;
+    };
+
+    std::unordered_map<const Diamond::Texture*, Entry> entries;
+    std::unordered_map<std::string, Diamond::Texture*> paths;
+
+    // most recently released first
+    std::list<const Diamond::Texture*> unreferenced;
+
+    size_t maxBytes;
+    size_t totalBytes, unreferencedBytes;
+    size_t numHits, numMisses, numEvictions;
+
+    void evict();
+};
+
+#endif // D_CD_TEXTURECACHE_H
@@ -0,0 +1,71 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#ifndef D_CD_THREADPOOL_H
+#define D_CD_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed number of worker threads that run submitted tasks
+ * in the order they were submitted.
+ * Tasks that haven't started when the pool is destroyed are dropped,
+ * and the destructor waits for running tasks to finish.
+ */
+class CDThreadPool {
+public:
+    /**
+     * Starts the given number of worker threads,
+     * or one per hardware thread if numThreads is 0.
+     */
+    explicit CDThreadPool(unsigned int numThreads = 0);
+    ~CDThreadPool();
+
+    CDThreadPool(const CDThreadPool&) = delete;
+    CDThreadPool& operator=(const CDThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    /**
+     * Calls fn(begin, end) over contiguous ranges that together cover
+     * [0, count), one range per worker plus one on the calling thread,
+     * and returns once all of them are done.
+     * Ranges have at least minPerRange elements, so counts under
+     * twice that run in one call on the calling thread.
+     * fn must not touch anything that another range does.
+     */
+    void parallelFor(size_t count, size_t minPerRange,
+                     const std::function<void(size_t begin, size_t end)>& fn);
+
+    unsigned int numThreads() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()> > tasks;
+    std::mutex mutex;
+    std::condition_variable taskReady;
+    bool stopping;
+
+    void work();
+};
+
+#endif // D_CD_THREADPOOL_H
@@ -0,0 +1,108 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef D_CD_TWEEN2D_H
+#define D_CD_TWEEN2D_H
+
+#include "D_typedefs.h"
+#include "CD_typedefs.h"
+
+// Tweened properties
+#define CD_TWEEN_POSITION 0 // of a transform, x and y
+#define CD_TWEEN_ROTATION 1 // of a transform, in degrees
+#define CD_TWEEN_SCALE    2 // of a transform, x and y
+#define CD_TWEEN_COLOR    3 // of a render component, r, g and b from 0 to 255
+#define CD_TWEEN_ALPHA    4 // of a render component, from 0 to 255
+
+// Easing curves
+#define CD_EASE_LINEAR        0
+#define CD_EASE_QUAD_IN       1
+#define CD_EASE_QUAD_OUT      2
+#define CD_EASE_QUAD_IN_OUT   3
+#define CD_EASE_CUBIC_IN      4
+#define CD_EASE_CUBIC_OUT     5
+#define CD_EASE_CUBIC_IN_OUT  6
+#define CD_EASE_SINE_IN       7
+#define CD_EASE_SINE_OUT      8
+#define CD_EASE_SINE_IN_OUT   9
+#define CD_EASE_BACK_OUT      10 // overshoots, then settles
+#define CD_EASE_ELASTIC_OUT   11
+#define CD_EASE_BOUNCE_OUT    12
+
+// Tween flags
+#define CD_TWEEN_YOYO     0x1 // every other loop plays backwards
+#define CD_TWEEN_RELATIVE 0x2 // to is added to the value the tween starts from
+
+typedef struct {
+    int   property; // CD_TWEEN_*
+    float to[3];    // the value to tween to, with as many components as the property
+    int   duration; // milliseconds for one play through
+    int   delay;    // milliseconds before the tween starts
+    int   easing;   // CD_EASE_*
+    int   loops;    // times to play again after the first, -1 for forever
+    int   flags;    // CD_TWEEN_YOYO and CD_TWEEN_RELATIVE
+} dTweenDef2D;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// frees all tweens
+CDEXPORT void dTween2DDestroyAll();
+
+/**
+ * Makes a tween of a transform's property (CD_TWEEN_POSITION, ROTATION
+ * or SCALE) or of a render component's (CD_TWEEN_COLOR or ALPHA),
+ * given by target. The tween starts from the property's value at the
+ * end of its delay, and is freed once it finishes.
+ * Tweens are updated by the game after movers and before nodes
+ * (see CD_Systems2D), so tweens override movers.
+ */
+CDEXPORT tCD_Handle dTween2DMakeTween(tCD_Handle target, const dTweenDef2D* def);
+
+/**
+ * Holds next until tween finishes, and then starts it (with its delay),
+ * so that tweens can be chained into sequences.
+ * A tween can only be followed by one tween.
+ */
+CDEXPORT void dTween2DThen(tCD_Handle tween, tCD_Handle next);
+
+// Stops and frees the tween, and the tweens that follow it.
+CDEXPORT void dTween2DDestroyTween(tCD_Handle tween);
+
+/**
+ * Stop and free all tweens of a transform or render component,
+ * and the tweens that follow them. Call this before destroying
+ * the transform or render component of a tween that hasn't finished.
+ */
+CDEXPORT void dTween2DDestroyTransformTweens(tCD_Handle transform);
+CDEXPORT void dTween2DDestroyRenderComponentTweens(tCD_Handle renderComponent);
+
+/**
+ * Copies up to maxTweens of the tweens that finished in the last update
+ * into tweens, and returns the number that finished.
+ * Their handles aren't reused until the update after.
+ */
+CDEXPORT int dTween2DGetFinished(tCD_Handle* tweens, int maxTweens);
+
+// Advances all running tweens and sets their properties.
+CDEXPORT void dTween2DUpdate(tD_delta delta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // D_CD_TWEEN2D_H
@@ -25,7 +25,7 @@
 #endif
 
 typedef int tCD_Handle;
-#define CD_INVALID_HANDLE -1;
+#define CD_INVALID_HANDLE -1
 
 typedef struct {
     float x;
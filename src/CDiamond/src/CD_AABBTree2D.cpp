@@ -0,0 +1,237 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "CD_AABBTree2D.h"
+
+#include <cstdlib>
+
+CDAABBTree2D::CDAABBTree2D(float margin)
+    : root(NULL_NODE), freeList(NULL_NODE), margin(margin) {}
+
+int CDAABBTree2D::allocateNode() {
+    if (freeList == NULL_NODE) {
+        nodes.push_back(Node());
+        freeList = nodes.size() - 1;
+        nodes[freeList].parent = NULL_NODE;
+    }
+
+    int id = freeList;
+    freeList = nodes[id].parent;
+
+    Node& node = nodes[id];
+    node.userData = nullptr;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+    return id;
+}
+
+void CDAABBTree2D::freeNode(int id) {
+    nodes[id].parent = freeList;
+    nodes[id].height = -1;
+    freeList = id;
+}
+
+int CDAABBTree2D::insert(const CDAABB2D& aabb, void* userData) {
+    int proxy = allocateNode();
+    nodes[proxy].aabb = {aabb.minX - margin, aabb.minY - margin,
+                         aabb.maxX + margin, aabb.maxY + margin};
+    nodes[proxy].userData = userData;
+    insertLeaf(proxy);
+    return proxy;
+}
+
+void CDAABBTree2D::remove(int proxy) {
+    removeLeaf(proxy);
+    freeNode(proxy);
+}
+
+void CDAABBTree2D::clear() {
+    nodes.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+}
+
+bool CDAABBTree2D::move(int proxy, const CDAABB2D& aabb, float dx, float dy) {
+    if (nodes[proxy].aabb.contains(aabb)) return false;
+
+    removeLeaf(proxy);
+
+    // extend the fat AABB in the direction of motion, so that
+    // objects moving steadily don't leave it again right away
+    CDAABB2D fat = {aabb.minX - margin, aabb.minY - margin,
+                    aabb.maxX + margin, aabb.maxY + margin};
+    if (dx < 0) fat.minX += 2 * dx;
+    else        fat.maxX += 2 * dx;
+    if (dy < 0) fat.minY += 2 * dy;
+    else        fat.maxY += 2 * dy;
+    nodes[proxy].aabb = fat;
+
+    insertLeaf(proxy);
+    return true;
+}
+
+void CDAABBTree2D::insertLeaf(int leaf) {
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // find the best sibling by the perimeter that inserting would add
+    CDAABB2D leafAABB = nodes[leaf].aabb;
+    int index = root;
+    while (!nodes[index].isLeaf()) {
+        const Node& node = nodes[index];
+        int child1 = node.child1;
+        int child2 = node.child2;
+
+        float perimeter = node.aabb.perimeter();
+        float combined = CDAABB2D::merge(node.aabb, leafAABB).perimeter();
+
+        // cost of making a new parent for this node and the leaf
+        float cost = 2 * combined;
+        // minimum cost of pushing the leaf further down
+        float inheritance = 2 * (combined - perimeter);
+
+        auto descendCost = [&](int child) {
+            CDAABB2D aabb = CDAABB2D::merge(leafAABB, nodes[child].aabb);
+            if (nodes[child].isLeaf())
+                return aabb.perimeter() + inheritance;
+            return aabb.perimeter() - nodes[child].aabb.perimeter() + inheritance;
+        };
+        float cost1 = descendCost(child1);
+        float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].aabb = CDAABB2D::merge(leafAABB, nodes[sibling].aabb);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE) {
+        root = newParent;
+    }
+    else if (nodes[oldParent].child1 == sibling) {
+        nodes[oldParent].child1 = newParent;
+    }
+    else {
+        nodes[oldParent].child2 = newParent;
+    }
+
+    fixUpwards(nodes[leaf].parent);
+}
+
+void CDAABBTree2D::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent == NULL_NODE) {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+        return;
+    }
+
+    // the sibling takes the parent's place
+    if (nodes[grandParent].child1 == parent)
+        nodes[grandParent].child1 = sibling;
+    else
+        nodes[grandParent].child2 = sibling;
+    nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    fixUpwards(grandParent);
+}
+
+void CDAABBTree2D::fixUpwards(int id) {
+    while (id != NULL_NODE) {
+        id = balance(id);
+
+        Node& node = nodes[id];
+        const Node& child1 = nodes[node.child1];
+        const Node& child2 = nodes[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.aabb = CDAABB2D::merge(child1.aabb, child2.aabb);
+
+        id = node.parent;
+    }
+}
+
+int CDAABBTree2D::balance(int iA) {
+    Node& A = nodes[iA];
+    if (A.isLeaf() || A.height < 2) return iA;
+
+    int iB = A.child1;
+    int iC = A.child2;
+    int diff = nodes[iC].height - nodes[iB].height;
+
+    if (std::abs(diff) <= 1) return iA;
+
+    // rotate the taller child (up) above A
+    int iUp = diff > 0 ? iC : iB;
+    int iOther = diff > 0 ? iB : iC;
+    Node& up = nodes[iUp];
+    int iF = up.child1;
+    int iG = up.child2;
+
+    up.child1 = iA;
+    up.parent = A.parent;
+    A.parent = iUp;
+
+    if (up.parent == NULL_NODE) {
+        root = iUp;
+    }
+    else if (nodes[up.parent].child1 == iA) {
+        nodes[up.parent].child1 = iUp;
+    }
+    else {
+        nodes[up.parent].child2 = iUp;
+    }
+
+    // the taller grandchild stays under up, the shorter goes under A
+    int iTall = nodes[iF].height > nodes[iG].height ? iF : iG;
+    int iShort = iTall == iF ? iG : iF;
+
+    up.child2 = iTall;
+    if (diff > 0) A.child2 = iShort;
+    else          A.child1 = iShort;
+    nodes[iShort].parent = iA;
+
+    A.aabb = CDAABB2D::merge(nodes[iOther].aabb, nodes[iShort].aabb);
+    A.height = 1 + std::max(nodes[iOther].height, nodes[iShort].height);
+    up.aabb = CDAABB2D::merge(A.aabb, nodes[iTall].aabb);
+    up.height = 1 + std::max(A.height, nodes[iTall].height);
+
+    return iUp;
+}
@@ -16,63 +16,378 @@
 
 #include "CD_Animation2D.h"
 
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
 #include "duSwapVector.h"
-#include "D_AnimatorSheet.h"
+#include "D_RenderComponent2D.h"
+#include "D_Texture.h"
 #include "CD_Renderer2D.h"
 using namespace Diamond;
 
-// TODO: refator engine so that animator is given an animation object
-// instead of an animation pointer!
-// for now, we have memory leaks if user doesn't free animations!
-static SwapVector<AnimationSheet*, tCD_Handle> animationSheets;
-static SwapVector<AnimatorSheet, tCD_Handle> animatorSheets;
+struct CDFrameRect {
+    int x, y, w, h;
+};
+
+// An animation sheet with the clip rectangle of each of its frames,
+// worked out once when it's loaded. The frames are laid out in rows
+// over the sprite sheet's texture, or over its region of an atlas page.
+struct CDAnimationSheet {
+    const Texture* texture;
+    int x, y, w, h;
+    tD_delta frameLength;
+    int numFrames, rows, columns;
+    std::vector<CDFrameRect> frames;
+    // loads of this sheet that haven't been destroyed,
+    // plus the animators that use it
+    int refCount = 0;
+};
+
+// Identical sheets are loaded once and shared.
+struct SheetKey {
+    const Texture* texture;
+    int x, y, w, h;
+    tD_delta frameLength;
+    int numFrames, rows, columns;
+
+    bool operator<(const SheetKey& other) const {
+        return std::tie(texture, x, y, w, h, frameLength, numFrames, rows, columns) <
+               std::tie(other.texture, other.x, other.y, other.w, other.h,
+                        other.frameLength, other.numFrames, other.rows, other.columns);
+    }
+};
+
+static SheetKey sheetKey(const CDAnimationSheet& sheet) {
+    return {sheet.texture, sheet.x, sheet.y, sheet.w, sheet.h,
+            sheet.frameLength, sheet.numFrames, sheet.rows, sheet.columns};
+}
+
+// Sheets are freed once they're destroyed as many times as they were loaded
+// and no animators use them, so animators never point to a freed sheet.
+static SwapVector<CDAnimationSheet*, tCD_Handle> animationSheets;
+static std::map<SheetKey, tCD_Handle> sheetHandles;
+
+/**
+ * Animators in parallel arrays, so that updating them is a pass over
+ * the arrays that only touches an animator's sheet and render component
+ * when its frame changes. Each animator keeps its own copy of what it
+ * needs from its sheet. Playing animators come first, so paused and
+ * finished ones are left out of updates.
+ */
+struct CDAnimators {
+    static const uint32_t NO_INDEX = UINT32_MAX;
+
+    std::vector<tD_delta> elapsed;
+    std::vector<tD_delta> frameLengths;
+    std::vector<int32_t> frames;
+    std::vector<int32_t> numFrames;
+    std::vector<uint8_t> loops;
+    std::vector<uint8_t> paused;
+    std::vector<const CDFrameRect*> frameRects;
+    std::vector<RenderComponent2D*> renderComponents;
+    std::vector<tCD_Handle> sheets;
+    std::vector<tCD_Handle> handles;
+    // the animators before this index are playing
+    uint32_t numPlaying = 0;
+
+    // By handle.
+    std::vector<uint32_t> indices;
+    std::vector<tCD_Handle> freeHandles;
+
+    // the animators that finished in the last update
+    std::vector<tCD_Handle> finished;
+
+    void swap(uint32_t a, uint32_t b) {
+        std::swap(elapsed[a], elapsed[b]);
+        std::swap(frameLengths[a], frameLengths[b]);
+        std::swap(frames[a], frames[b]);
+        std::swap(numFrames[a], numFrames[b]);
+        std::swap(loops[a], loops[b]);
+        std::swap(paused[a], paused[b]);
+        std::swap(frameRects[a], frameRects[b]);
+        std::swap(renderComponents[a], renderComponents[b]);
+        std::swap(sheets[a], sheets[b]);
+        std::swap(handles[a], handles[b]);
+        indices[handles[a]] = a;
+        indices[handles[b]] = b;
+    }
+
+    void popBack() {
+        elapsed.pop_back();
+        frameLengths.pop_back();
+        frames.pop_back();
+        numFrames.pop_back();
+        loops.pop_back();
+        paused.pop_back();
+        frameRects.pop_back();
+        renderComponents.pop_back();
+        sheets.pop_back();
+        handles.pop_back();
+    }
+
+    bool isPlaying(uint32_t index) const { return index < numPlaying; }
+
+    // Returns the animator's new index.
+    uint32_t play(uint32_t index) {
+        if (isPlaying(index)) return index;
+        swap(index, numPlaying);
+        return numPlaying++;
+    }
+
+    // Returns the animator's new index.
+    uint32_t stopPlaying(uint32_t index) {
+        if (!isPlaying(index)) return index;
+        swap(index, --numPlaying);
+        return numPlaying;
+    }
+};
+
+const uint32_t CDAnimators::NO_INDEX;
+
+static CDAnimators animators;
+
+static void retainSheet(tCD_Handle animationSheet) {
+    ++animationSheets[animationSheet]->refCount;
+}
+
+static void releaseSheet(tCD_Handle animationSheet) {
+    auto sheet = animationSheets[animationSheet];
+    if (--sheet->refCount > 0) return;
+
+    sheetHandles.erase(sheetKey(*sheet));
+    dRenderer2DReleaseTexture(sheet->texture);
+    delete sheet;
+    animationSheets.erase(animationSheet);
+}
+
+static void clipFrame(size_t animator) {
+    const CDFrameRect& rect = animators.frameRects[animator][animators.frames[animator]];
+    animators.renderComponents[animator]->setClip(rect.x, rect.y, rect.w, rect.h);
+}
+
+// Starts the animator at index animator from the first frame of the sheet,
+// without changing whether it's playing.
+static void setSheet(size_t animator, tCD_Handle animationSheet) {
+    auto sheet = animationSheets[animationSheet];
+    animators.elapsed[animator] = 0;
+    animators.frameLengths[animator] = sheet->frameLength;
+    animators.frames[animator] = 0;
+    animators.numFrames[animator] = sheet->numFrames;
+    animators.frameRects[animator] = sheet->frames.data();
+    animators.sheets[animator] = animationSheet;
+    clipFrame(animator);
+}
+
+static void rewind(size_t animator) {
+    animators.elapsed[animator] = 0;
+    if (animators.frames[animator] != 0) {
+        animators.frames[animator] = 0;
+        clipFrame(animator);
+    }
+}
+
+// Moves the animator at index animator on by the frames it's been on
+// past their length. Returns whether it played its last frame to the end
+// without looping.
+static bool advance(size_t animator) {
+    tD_delta frameLength = animators.frameLengths[animator];
+    int32_t steps = 1;
+    if (frameLength > 0) {
+        steps = animators.elapsed[animator] / frameLength;
+        animators.elapsed[animator] -= steps * frameLength;
+    }
+    else {
+        animators.elapsed[animator] = 0;
+    }
+
+    int32_t numFrames = animators.numFrames[animator];
+    int32_t frame = animators.frames[animator] + steps;
+    bool finished = false;
+    if (animators.loops[animator]) {
+        frame %= numFrames;
+    }
+    else if (frame >= numFrames) {
+        frame = numFrames - 1;
+        finished = true;
+    }
+
+    if (frame != animators.frames[animator]) {
+        animators.frames[animator] = frame;
+        clipFrame(animator);
+    }
+    return finished;
+}
 
 void dAnimation2DDestroyAll() {
     for (auto i = animationSheets.begin(); i != animationSheets.end(); ++i) {
+        dRenderer2DReleaseTexture((*i)->texture);
         delete *i;
     }
     animationSheets.clear();
-    animatorSheets.clear();
+    sheetHandles.clear();
+    animators = CDAnimators();
 }
 
 tCD_Handle dAnimation2DLoadAnimationSheet(
     tCD_Handle spritesheet, tD_delta frameLength, int numFrames, int rows, int cols
 ) {
-    auto sheet = new AnimationSheet();
-    sheet->sprite_sheet = dRenderer2DGetTexture(spritesheet).get();
-    sheet->frame_length = frameLength;
-    sheet->num_frames = numFrames;
-    sheet->rows = rows;
-    sheet->columns = cols;
-    return animationSheets.insert(sheet);
+    auto& tex = dRenderer2DGetTextureRegion(spritesheet);
+    CDAnimationSheet sheet;
+    sheet.texture = tex.texture.get();
+    if (tex.isRegion) {
+        sheet.x = tex.x;
+        sheet.y = tex.y;
+        sheet.w = tex.w;
+        sheet.h = tex.h;
+    }
+    else {
+        sheet.x = 0;
+        sheet.y = 0;
+        sheet.w = sheet.texture ? sheet.texture->getWidth() : 0;
+        sheet.h = sheet.texture ? sheet.texture->getHeight() : 0;
+    }
+    sheet.frameLength = frameLength;
+    sheet.numFrames = numFrames > 0 ? numFrames : 1;
+    sheet.rows = rows > 0 ? rows : 1;
+    sheet.columns = cols > 0 ? cols : 1;
+
+    auto key = sheetKey(sheet);
+    auto found = sheetHandles.find(key);
+    if (found != sheetHandles.end()) {
+        retainSheet(found->second);
+        return found->second;
+    }
+
+    int frameWidth = sheet.w / sheet.columns;
+    int frameHeight = sheet.h / sheet.rows;
+    sheet.frames.resize(sheet.numFrames);
+    for (int frame = 0; frame < sheet.numFrames; ++frame) {
+        sheet.frames[frame] = {sheet.x + (frame % sheet.columns) * frameWidth,
+                               sheet.y + (frame / sheet.columns) * frameHeight,
+                               frameWidth, frameHeight};
+    }
+
+    // keeps the sprite sheet loaded even if its texture handle is destroyed
+    dRenderer2DRetainTexture(sheet.texture);
+    auto handle = animationSheets.insert(new CDAnimationSheet(std::move(sheet)));
+    retainSheet(handle);
+    sheetHandles[key] = handle;
+    return handle;
 }
 
 void dAnimation2DDestroyAnimationSheet(tCD_Handle animationSheet) {
-    delete animationSheets[animationSheet];
-    animationSheets.erase(animationSheet);
+    releaseSheet(animationSheet);
 }
 
 tCD_Handle dAnimation2DMakeAnimatorSheet(
     tCD_Handle renderComponent, tCD_Handle animationSheet
 ) {
-    return animatorSheets.emplace(dRenderComponent2DGetRenderComponent(renderComponent).get(),
-                                  animationSheets[animationSheet]);
+    tCD_Handle animator;
+    if (!animators.freeHandles.empty()) {
+        animator = animators.freeHandles.back();
+        animators.freeHandles.pop_back();
+    }
+    else {
+        animator = animators.indices.size();
+        animators.indices.push_back(CDAnimators::NO_INDEX);
+    }
+
+    size_t index = animators.handles.size();
+    animators.elapsed.push_back(0);
+    animators.frameLengths.push_back(0);
+    animators.frames.push_back(0);
+    animators.numFrames.push_back(1);
+    animators.loops.push_back(true);
+    animators.paused.push_back(false);
+    animators.frameRects.push_back(nullptr);
+    animators.renderComponents.push_back(
+        dRenderComponent2DGetRenderComponent(renderComponent).get()
+    );
+    animators.sheets.push_back(animationSheet);
+    animators.handles.push_back(animator);
+    animators.indices[animator] = index;
+
+    retainSheet(animationSheet);
+    setSheet(index, animationSheet);
+    animators.play(index);
+    return animator;
 }
 
 void dAnimation2DDestroyAnimatorSheet(tCD_Handle animatorSheet) {
-    animatorSheets.erase(animatorSheet);
+    uint32_t index = animators.stopPlaying(animators.indices[animatorSheet]);
+    releaseSheet(animators.sheets[index]);
+
+    animators.swap(index, animators.handles.size() - 1);
+    animators.popBack();
+
+    animators.indices[animatorSheet] = CDAnimators::NO_INDEX;
+    animators.freeHandles.push_back(animatorSheet);
 }
 
 // Sets the given animator's animation to the given animation sheet
 void dAnimation2DSetAnimationSheet(
     tCD_Handle animatorSheet, tCD_Handle animationSheet
 ) {
-    animatorSheets[animatorSheet].setAnimation(animationSheets[animationSheet]);
+    uint32_t index = animators.indices[animatorSheet];
+    retainSheet(animationSheet);
+    releaseSheet(animators.sheets[index]);
+    setSheet(index, animationSheet);
+    if (!animators.paused[index]) animators.play(index);
+}
+
+void dAnimation2DPlay(tCD_Handle animatorSheet) {
+    uint32_t index = animators.indices[animatorSheet];
+    // a finished animator starts over
+    if (!animators.isPlaying(index) && !animators.paused[index]) rewind(index);
+    animators.paused[index] = false;
+    animators.play(index);
+}
+
+void dAnimation2DPause(tCD_Handle animatorSheet) {
+    uint32_t index = animators.stopPlaying(animators.indices[animatorSheet]);
+    animators.paused[index] = true;
+}
+
+void dAnimation2DStop(tCD_Handle animatorSheet) {
+    uint32_t index = animators.stopPlaying(animators.indices[animatorSheet]);
+    animators.paused[index] = true;
+    rewind(index);
+}
+
+bool dAnimation2DIsPlaying(tCD_Handle animatorSheet) {
+    return animators.isPlaying(animators.indices[animatorSheet]);
+}
+
+void dAnimation2DSetLoop(tCD_Handle animatorSheet, bool loop) {
+    animators.loops[animators.indices[animatorSheet]] = loop;
+}
+
+int dAnimation2DGetFinished(tCD_Handle* animatorSheets, int maxAnimators) {
+    int numFinished = animators.finished.size();
+    for (int i = 0; i < numFinished && i < maxAnimators; ++i) {
+        animatorSheets[i] = animators.finished[i];
+    }
+    return numFinished;
 }
 
 // Updates all animations for the current frame
 void dAnimation2DUpdate(tD_delta delta) {
-    for (auto i = animatorSheets.begin(); i != animatorSheets.end(); ++i) {
-        i->update(delta);
+    animators.finished.clear();
+
+    size_t count = animators.numPlaying;
+    tD_delta* elapsed = animators.elapsed.data();
+    const tD_delta* frameLengths = animators.frameLengths.data();
+
+    for (size_t i = 0; i < count; ++i) {
+        elapsed[i] += delta;
+    }
+    // backwards, so that finished animators are swapped
+    // with ones that were already advanced
+    for (size_t i = count; i-- > 0;) {
+        if (elapsed[i] >= frameLengths[i] && advance(i)) {
+            animators.finished.push_back(animators.handles[i]);
+            animators.stopPlaying(i);
+        }
     }
 }
@@ -0,0 +1,146 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "CD_BodyTable.h"
+
+#include <algorithm>
+using namespace Diamond;
+
+// Moves the last element of v into index and drops the last element.
+template <typename T>
+static void swapRemove(std::vector<T>& v, uint32_t index) {
+    v[index] = v.back();
+    v.pop_back();
+}
+
+const uint32_t CDBodyTable::NO_INDEX;
+
+void CDBodyTable::add(uint32_t id, DTransform2* transform) {
+    if (indices.size() <= id) indices.resize(id + 1, NO_INDEX);
+    indices[id] = bodyIDs.size();
+
+    for (auto x : {&posX, &prevX, &shownX}) x->push_back(transform->position.x);
+    for (auto y : {&posY, &prevY, &shownY}) y->push_back(transform->position.y);
+    for (auto r : {&rot, &prevRot, &shownRot}) r->push_back(transform->rotation);
+    transformPtrs.push_back(transform);
+    bodyIDs.push_back(id);
+}
+
+void CDBodyTable::remove(uint32_t id) {
+    uint32_t index = indices[id];
+
+    for (auto v : {&posX, &posY, &prevX, &prevY, &shownX, &shownY}) swapRemove(*v, index);
+    for (auto v : {&rot, &prevRot, &shownRot}) swapRemove(*v, index);
+    swapRemove(transformPtrs, index);
+    swapRemove(bodyIDs, index);
+
+    if (index < bodyIDs.size()) indices[bodyIDs[index]] = index;
+    indices[id] = NO_INDEX;
+}
+
+void CDBodyTable::setThreadPool(CDThreadPool* pool, size_t minPerRange) {
+    this->pool = pool;
+    this->minPerRange = minPerRange;
+}
+
+template <typename F>
+void CDBodyTable::forRanges(F fn) const {
+    if (pool)
+        pool->parallelFor(size(), minPerRange, fn);
+    else
+        fn(0, size());
+}
+
+void CDBodyTable::pullTransforms() {
+    forRanges([this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto transform = transformPtrs[i];
+            posX[i] = transform->position.x;
+            posY[i] = transform->position.y;
+            rot[i] = transform->rotation;
+        }
+    });
+}
+
+void CDBodyTable::pushTransforms() const {
+    forRanges([this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto transform = transformPtrs[i];
+            transform->position.x = posX[i];
+            transform->position.y = posY[i];
+            transform->rotation = rot[i];
+        }
+    });
+}
+
+void CDBodyTable::pullTransforms(const tD_pos* x, const tD_pos* y, const tD_rot* rotation) {
+    std::copy(x, x + size(), posX.begin());
+    std::copy(y, y + size(), posY.begin());
+    std::copy(rotation, rotation + size(), rot.begin());
+}
+
+void CDBodyTable::pushTransforms(tD_pos* x, tD_pos* y, tD_rot* rotation) const {
+    std::copy(posX.begin(), posX.end(), x);
+    std::copy(posY.begin(), posY.end(), y);
+    std::copy(rot.begin(), rot.end(), rotation);
+}
+
+void CDBodyTable::savePrevious() {
+    prevX = posX;
+    prevY = posY;
+    prevRot = rot;
+}
+
+void CDBodyTable::interpolate(float alpha) {
+    forRanges([this, alpha](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            shownX[i] = prevX[i] + (posX[i] - prevX[i]) * alpha;
+            shownY[i] = prevY[i] + (posY[i] - prevY[i]) * alpha;
+
+            // turn the short way around
+            tD_rot turn = rot[i] - prevRot[i];
+            if (turn > 180) turn -= 360;
+            else if (turn < -180) turn += 360;
+            shownRot[i] = prevRot[i] + turn * alpha;
+
+            auto transform = transformPtrs[i];
+            transform->position.x = shownX[i];
+            transform->position.y = shownY[i];
+            transform->rotation = shownRot[i];
+        }
+    });
+}
+
+void CDBodyTable::restoreTransforms() {
+    forRanges([this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto transform = transformPtrs[i];
+            if (transform->position.x != shownX[i] ||
+                transform->position.y != shownY[i] ||
+                transform->rotation != shownRot[i]) {
+                prevX[i] = posX[i] = transform->position.x;
+                prevY[i] = posY[i] = transform->position.y;
+                prevRot[i] = rot[i] = transform->rotation;
+            }
+            else {
+                transform->position.x = posX[i];
+                transform->position.y = posY[i];
+                transform->rotation = rot[i];
+            }
+        }
+    });
+}
@@ -0,0 +1,383 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "CD_Bundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "SDL.h"
+#include "duSwapVector.h"
+#include "D_Log.h"
+#include "D_SDLTexture.h"
+#include "CD_Animation2D.h"
+#include "CD_BundleFormat.h"
+#include "CD_Config.h"
+#include "CD_Renderer2D.h"
+
+#if defined _WIN32 || defined _WIN64
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace Diamond;
+
+struct CDBundle {
+    const char* data;
+    size_t size;
+#if defined _WIN32 || defined _WIN64
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    const dBundleEntry* entries;
+    uint32_t numEntries;
+
+    // made on first use, by entry index
+    std::vector<DumbPtr<Texture> > images;
+    std::vector<tCD_Handle> textures;
+
+    const char* string(uint32_t offset) const { return data + offset; }
+};
+
+static SwapVector<CDBundle, tCD_Handle> bundles;
+
+static bool mapFile(const char* path, CDBundle& bundle) {
+#if defined _WIN32 || defined _WIN64
+    bundle.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (bundle.file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(bundle.file, &size);
+    bundle.size = (size_t)size.QuadPart;
+
+    bundle.mapping = CreateFileMappingA(bundle.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (bundle.mapping)
+        bundle.data = (const char*)MapViewOfFile(bundle.mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!bundle.data) {
+        if (bundle.mapping) CloseHandle(bundle.mapping);
+        CloseHandle(bundle.file);
+        return false;
+    }
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    bundle.size = info.st_size;
+
+    // the mapping stays valid after the file is closed
+    void* data = mmap(nullptr, bundle.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    bundle.data = (const char*)data;
+    return true;
+#endif
+}
+
+static void unmapFile(CDBundle& bundle) {
+#if defined _WIN32 || defined _WIN64
+    UnmapViewOfFile(bundle.data);
+    CloseHandle(bundle.mapping);
+    CloseHandle(bundle.file);
+#else
+    munmap((void*)bundle.data, bundle.size);
+#endif
+    bundle.data = nullptr;
+}
+
+static bool inRect(int32_t x, int32_t y, int32_t w, int32_t h,
+                   int32_t width, int32_t height) {
+    return x >= 0 && y >= 0 && w >= 0 && h >= 0 &&
+           (int64_t)x + w <= width && (int64_t)y + h <= height;
+}
+
+// Checks that the header, entries, config pairs and sprite rects don't
+// point outside the file or their images, and that names are sorted and
+// unique, so that lookups don't have to.
+static bool validate(const CDBundle& bundle) {
+    if (bundle.size < sizeof(dBundleHeader)) return false;
+    // so that no name or string can run past the end of the file
+    if (bundle.data[bundle.size - 1] != '\0') return false;
+
+    auto header = (const dBundleHeader*)bundle.data;
+    if (std::memcmp(header->magic, CD_BUNDLE_MAGIC, 4) != 0 ||
+        header->version != CD_BUNDLE_VERSION ||
+        header->entriesOffset > bundle.size ||
+        header->numEntries > (bundle.size - header->entriesOffset) / sizeof(dBundleEntry))
+        return false;
+
+    auto entries = (const dBundleEntry*)(bundle.data + header->entriesOffset);
+    for (uint32_t i = 0; i < header->numEntries; ++i) {
+        auto& entry = entries[i];
+        if (entry.nameOffset >= bundle.size ||
+            entry.dataOffset > bundle.size ||
+            entry.dataSize > bundle.size - entry.dataOffset)
+            return false;
+
+        // findEntry's binary search needs names in order
+        if (i > 0 && std::strcmp(bundle.data + entries[i - 1].nameOffset,
+                                 bundle.data + entry.nameOffset) >= 0)
+            return false;
+
+        switch (entry.type) {
+        case CD_BUNDLE_IMAGE:
+            if (entry.image.width < 0 || entry.image.height < 0 ||
+                (uint64_t)entry.image.width * entry.image.height * 4 > entry.dataSize)
+                return false;
+            break;
+        case CD_BUNDLE_SPRITE: {
+            if ((uint32_t)entry.sprite.image >= header->numEntries)
+                return false;
+            auto& image = entries[entry.sprite.image];
+            if (image.type != CD_BUNDLE_IMAGE ||
+                !inRect(entry.sprite.x, entry.sprite.y, entry.sprite.w, entry.sprite.h,
+                        image.image.width, image.image.height))
+                return false;
+            break;
+        }
+        case CD_BUNDLE_CONFIG: {
+            if (entry.config.numPairs < 0 ||
+                (uint64_t)entry.config.numPairs * sizeof(dBundleConfigPair) > entry.dataSize)
+                return false;
+            auto pairs = (const dBundleConfigPair*)(bundle.data + entry.dataOffset);
+            for (int32_t p = 0; p < entry.config.numPairs; ++p) {
+                if (pairs[p].keyOffset >= bundle.size || pairs[p].valueOffset >= bundle.size)
+                    return false;
+            }
+            break;
+        }
+        case CD_BUNDLE_ANIMATION: {
+            if ((uint32_t)entry.animation.spritesheet >= header->numEntries)
+                return false;
+            auto type = entries[entry.animation.spritesheet].type;
+            if (type != CD_BUNDLE_IMAGE && type != CD_BUNDLE_SPRITE)
+                return false;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the index of the entry with the given name and type, or -1.
+// Names are unique across types (see validate).
+static int findEntry(const CDBundle& bundle, const char* name, uint32_t type) {
+    auto end = bundle.entries + bundle.numEntries;
+    auto entry = std::lower_bound(bundle.entries, end, name,
+        [&bundle](const dBundleEntry& entry, const char* name) {
+            return std::strcmp(bundle.string(entry.nameOffset), name) < 0;
+        });
+
+    if (entry == end || std::strcmp(bundle.string(entry->nameOffset), name) != 0 ||
+        entry->type != type)
+        return -1;
+    return entry - bundle.entries;
+}
+
+static DumbPtr<Texture> loadImage(CDBundle& bundle, int index) {
+    if (bundle.images[index]) return bundle.images[index];
+
+    auto sdlRenderer = dRenderer2DGetSDLRenderer();
+    if (!sdlRenderer) return nullptr;
+
+    auto& image = bundle.entries[index].image;
+    auto sdlTexture = SDL_CreateTexture(sdlRenderer, SDL_PIXELFORMAT_RGBA32,
+                                        SDL_TEXTUREACCESS_STATIC,
+                                        image.width, image.height);
+    if (!sdlTexture) {
+        Log::log("Failed to make bundle texture " +
+                 std::string(bundle.string(bundle.entries[index].nameOffset)) +
+                 "! SDL Error: " + std::string(SDL_GetError()));
+        return nullptr;
+    }
+
+    // uploaded straight from the mapped file
+    SDL_UpdateTexture(sdlTexture, nullptr,
+                      bundle.data + bundle.entries[index].dataOffset,
+                      image.width * 4);
+    SDL_SetTextureBlendMode(sdlTexture, SDL_BLENDMODE_BLEND);
+
+    bundle.images[index] = DumbPtr<Texture>(new SDLTexture(sdlTexture, image.width, image.height));
+    return bundle.images[index];
+}
+
+// Returns the texture handle of the given image or sprite entry.
+static tCD_Handle loadTexture(CDBundle& bundle, int index) {
+    if (bundle.textures[index] != CD_INVALID_HANDLE) return bundle.textures[index];
+
+    auto& entry = bundle.entries[index];
+    if (entry.type == CD_BUNDLE_IMAGE) {
+        auto image = loadImage(bundle, index);
+        if (image) {
+            bundle.textures[index] = dRenderer2DMakeTextureRegion(
+                image, 0, 0, entry.image.width, entry.image.height
+            );
+        }
+    }
+    else if (entry.type == CD_BUNDLE_SPRITE) {
+        auto image = loadImage(bundle, entry.sprite.image);
+        if (image) {
+            bundle.textures[index] = dRenderer2DMakeTextureRegion(
+                image, entry.sprite.x, entry.sprite.y, entry.sprite.w, entry.sprite.h
+            );
+        }
+    }
+
+    return bundle.textures[index];
+}
+
+static void freeBundle(CDBundle& bundle) {
+    for (auto texture : bundle.textures) {
+        if (texture != CD_INVALID_HANDLE) dRenderer2DDestroyTextureRegion(texture);
+    }
+    for (auto& image : bundle.images) {
+        image.free();
+    }
+    unmapFile(bundle);
+}
+
+tCD_Handle dBundleOpen(char* path) {
+    CDBundle bundle = {};
+    if (!mapFile(path, bundle)) {
+        Log::log("Failed to open bundle " + std::string(path) + "!");
+        return CD_INVALID_HANDLE;
+    }
+
+    if (!validate(bundle)) {
+        Log::log(std::string(path) + " is not a valid bundle!");
+        unmapFile(bundle);
+        return CD_INVALID_HANDLE;
+    }
+
+    auto header = (const dBundleHeader*)bundle.data;
+    bundle.entries = (const dBundleEntry*)(bundle.data + header->entriesOffset);
+    bundle.numEntries = header->numEntries;
+    bundle.images.resize(bundle.numEntries);
+    bundle.textures.resize(bundle.numEntries, -1);
+
+    return bundles.insert(bundle);
+}
+
+void dBundleClose(tCD_Handle bundle) {
+    freeBundle(bundles[bundle]);
+    bundles.erase(bundle);
+}
+
+void dBundleCloseAll() {
+    for (auto& bundle : bundles) {
+        freeBundle(bundle);
+    }
+    bundles.clear();
+}
+
+tCD_Handle dBundleLoadTexture(tCD_Handle bundle, char* name) {
+    auto& b = bundles[bundle];
+    int index = findEntry(b, name, CD_BUNDLE_SPRITE);
+    if (index < 0) index = findEntry(b, name, CD_BUNDLE_IMAGE);
+    if (index < 0) return CD_INVALID_HANDLE;
+    return loadTexture(b, index);
+}
+
+bool dBundleGetAnimation(tCD_Handle bundle, char* name,
+                         tCD_Handle* spritesheet,
+                         int* frameLength,
+                         int* numFrames,
+                         int* rows,
+                         int* columns) {
+    auto& b = bundles[bundle];
+    int index = findEntry(b, name, CD_BUNDLE_ANIMATION);
+    if (index < 0) return false;
+
+    auto& animation = b.entries[index].animation;
+    *spritesheet = loadTexture(b, animation.spritesheet);
+    *frameLength = animation.frameLength;
+    *numFrames = animation.numFrames;
+    *rows = animation.rows;
+    *columns = animation.columns;
+    return *spritesheet != CD_INVALID_HANDLE;
+}
+
+tCD_Handle dBundleLoadAnimationSheet(tCD_Handle bundle, char* name) {
+    tCD_Handle spritesheet;
+    int frameLength, numFrames, rows, columns;
+    if (!dBundleGetAnimation(bundle, name, &spritesheet,
+                             &frameLength, &numFrames, &rows, &columns))
+        return CD_INVALID_HANDLE;
+
+    return dAnimation2DLoadAnimationSheet(spritesheet, frameLength,
+                                          numFrames, rows, columns);
+}
+
+static const dBundleConfigPair* configPairs(const CDBundle& bundle, int index) {
+    return (const dBundleConfigPair*)(bundle.data + bundle.entries[index].dataOffset);
+}
+
+tCD_Handle dBundleLoadConfigTable(tCD_Handle bundle, char* name) {
+    auto& b = bundles[bundle];
+    int index = findEntry(b, name, CD_BUNDLE_CONFIG);
+    if (index < 0) return CD_INVALID_HANDLE;
+
+    tCD_Handle configtable = dConfigMakeConfigTable();
+    auto& table = dConfigGetConfigTable(configtable);
+    auto pairs = configPairs(b, index);
+    for (int i = 0; i < b.entries[index].config.numPairs; ++i) {
+        table.set(b.string(pairs[i].keyOffset), b.string(pairs[i].valueOffset));
+    }
+    return configtable;
+}
+
+int dBundleGetConfigSize(tCD_Handle bundle, char* name) {
+    auto& b = bundles[bundle];
+    int index = findEntry(b, name, CD_BUNDLE_CONFIG);
+    if (index < 0) return -1;
+    return b.entries[index].config.numPairs;
+}
+
+// Returns the i-th pair of the config with the given name,
+// or nullptr if there isn't one.
+static const dBundleConfigPair* configPair(const CDBundle& bundle, const char* name, int i) {
+    int index = findEntry(bundle, name, CD_BUNDLE_CONFIG);
+    if (index < 0 || i < 0 || i >= bundle.entries[index].config.numPairs) return nullptr;
+    return configPairs(bundle, index) + i;
+}
+
+const char* dBundleGetConfigKey(tCD_Handle bundle, char* name, int i) {
+    auto& b = bundles[bundle];
+    auto pair = configPair(b, name, i);
+    return pair ? b.string(pair->keyOffset) : nullptr;
+}
+
+const char* dBundleGetConfigValue(tCD_Handle bundle, char* name, int i) {
+    auto& b = bundles[bundle];
+    auto pair = configPair(b, name, i);
+    return pair ? b.string(pair->valueOffset) : nullptr;
+}
@@ -0,0 +1,187 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "CD_ECSWorld.h"
+
+#include <atomic>
+#include <cstring>
+
+const uint32_t CDECSWorld::NO_ARCHETYPE;
+
+static std::atomic<uint32_t> nextComponentType(0);
+
+tCD_ComponentType cdNewComponentType() {
+    uint32_t type = nextComponentType++;
+    return type < CD_ECS_MAX_COMPONENTS ? type : CD_ECS_MAX_COMPONENTS;
+}
+
+static tCD_ComponentMask componentBit(tCD_ComponentType type) {
+    return (tCD_ComponentMask)1 << type;
+}
+
+CDECSWorld::CDECSWorld() : componentSizes(CD_ECS_MAX_COMPONENTS, 0) {
+    // entities start out in the archetype with no components
+    findArchetype(0);
+}
+
+tCD_Handle CDECSWorld::makeEntity() {
+    tCD_Handle entity;
+    if (!freeHandles.empty()) {
+        entity = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else {
+        entity = entityArchetypes.size();
+        entityArchetypes.push_back(NO_ARCHETYPE);
+        rows.push_back(0);
+    }
+
+    Archetype& empty = archetypes[0];
+    entityArchetypes[entity] = 0;
+    rows[entity] = empty.entities.size();
+    empty.entities.push_back(entity);
+    return entity;
+}
+
+void CDECSWorld::destroyEntity(tCD_Handle entity) {
+    if (!contains(entity))
+        return;
+    removeRow(archetypes[entityArchetypes[entity]], rows[entity]);
+    entityArchetypes[entity] = NO_ARCHETYPE;
+    freeHandles.push_back(entity);
+}
+
+void CDECSWorld::setComponentSize(tCD_ComponentType type, size_t size) {
+    if (type < CD_ECS_MAX_COMPONENTS && componentSizes[type] == 0)
+        componentSizes[type] = size > 0 ? size : 1;
+}
+
+void* CDECSWorld::addComponent(tCD_Handle entity, tCD_ComponentType type, const void* data) {
+    if (!contains(entity) || type >= CD_ECS_MAX_COMPONENTS || componentSizes[type] == 0)
+        return nullptr;
+
+    uint32_t from = entityArchetypes[entity];
+    if (!(archetypes[from].mask & componentBit(type))) {
+        int32_t to = archetypes[from].addEdges[type];
+        if (to < 0) {
+            to = findArchetype(archetypes[from].mask | componentBit(type));
+            archetypes[from].addEdges[type] = to;
+        }
+        moveEntity(entity, to);
+    }
+
+    void* component = getComponent(entity, type);
+    if (data)
+        std::memcpy(component, data, componentSizes[type]);
+    else
+        std::memset(component, 0, componentSizes[type]);
+    return component;
+}
+
+bool CDECSWorld::removeComponent(tCD_Handle entity, tCD_ComponentType type) {
+    if (!contains(entity) || type >= CD_ECS_MAX_COMPONENTS)
+        return false;
+
+    uint32_t from = entityArchetypes[entity];
+    if (!(archetypes[from].mask & componentBit(type)))
+        return false;
+
+    int32_t to = archetypes[from].removeEdges[type];
+    if (to < 0) {
+        to = findArchetype(archetypes[from].mask & ~componentBit(type));
+        archetypes[from].removeEdges[type] = to;
+    }
+    moveEntity(entity, to);
+    return true;
+}
+
+void* CDECSWorld::getComponent(tCD_Handle entity, tCD_ComponentType type) {
+    if (!contains(entity) || type >= CD_ECS_MAX_COMPONENTS)
+        return nullptr;
+
+    Archetype& archetype = archetypes[entityArchetypes[entity]];
+    int column = archetype.columnOf[type];
+    if (column < 0)
+        return nullptr;
+    return &archetype.columns[column][rows[entity] * componentSizes[type]];
+}
+
+uint32_t CDECSWorld::findArchetype(tCD_ComponentMask mask) {
+    auto it = archetypeIndices.find(mask);
+    if (it != archetypeIndices.end())
+        return it->second;
+
+    Archetype archetype;
+    archetype.mask = mask;
+    for (tCD_ComponentType type = 0; type < CD_ECS_MAX_COMPONENTS; ++type) {
+        archetype.addEdges[type] = -1;
+        archetype.removeEdges[type] = -1;
+        if (mask & componentBit(type)) {
+            archetype.columnOf[type] = archetype.types.size();
+            archetype.types.push_back(type);
+        }
+        else {
+            archetype.columnOf[type] = -1;
+        }
+    }
+    archetype.columns.resize(archetype.types.size());
+
+    uint32_t index = archetypes.size();
+    archetypes.push_back(std::move(archetype));
+    archetypeIndices[mask] = index;
+    return index;
+}
+
+void CDECSWorld::moveEntity(tCD_Handle entity, uint32_t to) {
+    Archetype& from = archetypes[entityArchetypes[entity]];
+    Archetype& dest = archetypes[to];
+    uint32_t row = rows[entity];
+    uint32_t newRow = dest.entities.size();
+
+    dest.entities.push_back(entity);
+    for (size_t c = 0; c < dest.columns.size(); ++c) {
+        tCD_ComponentType type = dest.types[c];
+        size_t size = componentSizes[type];
+        std::vector<unsigned char>& column = dest.columns[c];
+        column.resize(column.size() + size);
+        int fromColumn = from.columnOf[type];
+        if (fromColumn >= 0)
+            std::memcpy(&column[newRow * size], &from.columns[fromColumn][row * size], size);
+    }
+
+    removeRow(from, row);
+    entityArchetypes[entity] = to;
+    rows[entity] = newRow;
+}
+
+void CDECSWorld::removeRow(Archetype& archetype, uint32_t row) {
+    // move the last row into the removed one
+    uint32_t last = archetype.entities.size() - 1;
+    for (size_t c = 0; c < archetype.columns.size(); ++c) {
+        size_t size = componentSizes[archetype.types[c]];
+        std::vector<unsigned char>& column = archetype.columns[c];
+        if (row != last)
+            std::memcpy(&column[row * size], &column[last * size], size);
+        column.resize(last * size);
+    }
+
+    if (row != last) {
+        tCD_Handle moved = archetype.entities[last];
+        archetype.entities[row] = moved;
+        rows[moved] = row;
+    }
+    archetype.entities.pop_back();
+}
@@ -15,11 +15,71 @@
 */
 
 #include "CD_Engine2D.h"
+
+#include "D_SDLRenderer2D.h"
 #include "CD_Game2D.h"
+#include "CD_NativeWorld2D.h"
 using namespace Diamond;
 
+// SDLRenderer2D doesn't expose its SDL renderer, so it's found through
+// the window that it made. SDL numbers windows from 1, and the engine's
+// window is the only one left open, so it's the first one still found.
+static SDL_Renderer* findSDLRenderer() {
+    const Uint32 maxWindowID = 64;
+    for (Uint32 id = 1; id <= maxWindowID; ++id) {
+        auto window = SDL_GetWindowFromID(id);
+        if (window) return SDL_GetRenderer(window);
+    }
+    return nullptr;
+}
+
+// Lets CDiamond subsystems interpose on the engine's own subsystems
+// (ex. to instrument the renderer or physics) without changing the engine's game loop.
+class CDEngine2D final : public Engine2D {
+public:
+    CDEngine2D(const Config& config, bool& success)
+        : Engine2D(config, success),
+          engineRenderer(renderer),
+          enginePhysWorld(phys_world),
+          sdlRenderer(nullptr) {
+        if (dynamic_cast<SDLRenderer2D*>(engineRenderer))
+            sdlRenderer = findSDLRenderer();
+    }
+
+    // the engine frees its subsystems on destruction,
+    // so make sure it frees its own and not a borrowed one.
+    ~CDEngine2D() {
+        renderer = engineRenderer;
+        phys_world = enginePhysWorld;
+    }
+
+    Renderer2D* swapRenderer(Renderer2D* newRenderer) {
+        auto oldRenderer = renderer;
+        renderer = newRenderer;
+        return oldRenderer;
+    }
+
+    PhysicsWorld2D* swapPhysWorld(PhysicsWorld2D* newPhysWorld) {
+        auto oldPhysWorld = phys_world;
+        phys_world = newPhysWorld;
+        return oldPhysWorld;
+    }
+
+    SDL_Renderer* getSDLRenderer() const { return sdlRenderer; }
+
+private:
+    Renderer2D* engineRenderer;
+    PhysicsWorld2D* enginePhysWorld;
+    // kept from the engine's own renderer, which stays alive
+    // for as long as the engine even while another one is swapped in
+    SDL_Renderer* sdlRenderer;
+};
+
 static Config config;
-static Engine2D* engine = nullptr;
+static CDPhysicsConfig2D physicsConfig;
+static int physicsBackend = CD_PHYSICS_QUANTUM;
+static CDEngine2D* engine = nullptr;
+static CDNativeWorld2D* nativeWorld = nullptr;
 
 void dEngine2DConfigureGraphics(char* windowTitle,
                                 int windowWidth,
@@ -41,21 +101,48 @@ void dEngine2DConfigureAudio(int numChannels,
     config.audio_out_sample_size = sampleSize;
 }
 
+void dEngine2DConfigurePhysics(tD_delta fixedStep,
+                               int maxSubsteps,
+                               bool interpolate) {
+    physicsConfig.fixedStep = fixedStep;
+    physicsConfig.maxSubsteps = maxSubsteps;
+    physicsConfig.interpolate = interpolate;
+}
+
+void dEngine2DConfigurePhysicsBackend(int backend) {
+    physicsBackend = backend;
+}
+
+void dEngine2DConfigurePhysicsThreads(int numThreads,
+                                      int minBodiesPerThread) {
+    physicsConfig.numThreads = numThreads;
+    physicsConfig.minBodiesPerThread = minBodiesPerThread;
+}
+
 bool dEngine2DInit() {
     bool success = true;
-    engine = new Engine2D(config, success);
+    engine = new CDEngine2D(config, success);
+
+    if (success && physicsBackend == CD_PHYSICS_NATIVE) {
+        nativeWorld = new CDNativeWorld2D();
+        success = nativeWorld->init(config);
+        if (success)
+            engine->swapPhysWorld(nativeWorld);
+    }
 
     if (!success) {
-        delete engine;
-        engine = nullptr;
+        dEngine2DDestroy();
     }
 
     return success;
 }
 
 void dEngine2DDestroy() {
+    // the engine puts its own physics world back first
     delete engine;
     engine = nullptr;
+    delete nativeWorld;
+    nativeWorld = nullptr;
 }
 
 void dEngine2DLaunchGame() {
@@ -73,3 +160,19 @@ void dEngine2DQuitGame() {
 Engine2D* dEngine2DGetEngine() {
     return engine;
 }
+
+SDL_Renderer* dEngine2DGetSDLRenderer() {
+    return engine ? engine->getSDLRenderer() : nullptr;
+}
+
+const CDPhysicsConfig2D& dEngine2DGetPhysicsConfig() {
+    return physicsConfig;
+}
+
+Renderer2D* dEngine2DSwapRenderer(Renderer2D* renderer) {
+    return engine->swapRenderer(renderer);
+}
+
+PhysicsWorld2D* dEngine2DSwapPhysWorld(PhysicsWorld2D* physWorld) {
+    return engine->swapPhysWorld(physWorld);
+}
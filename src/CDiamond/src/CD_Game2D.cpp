@@ -20,6 +20,8 @@
 #include "D_Benchmark.h"
 #include "D_Log.h"
 #include "CD_Engine2D.h"
+#include "CD_Node2D.h"
+#include "CD_Systems2D.h"
 using namespace Diamond;
 
 template <typename FVoid, typename FUpdate>
@@ -58,10 +60,15 @@ public:
     void update(tD_delta delta) override {
 
         if (updateFunc) updateFunc(delta);
+        // including the node update, so that children follow
+        // what game logic moved before physics sees them
+        dSystems2DUpdate(delta);
         if (benchmarkLogger) benchmarkLogger->update(delta);
     }
 
     void postPhysicsUpdate(tD_delta delta) override {
+        // children follow what physics moved before game logic sees them
+        dNode2DUpdate();
         if (postPhysicsUpdateFunc) postPhysicsUpdateFunc(delta);
     }
 
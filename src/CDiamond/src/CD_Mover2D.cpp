@@ -0,0 +1,186 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "CD_Mover2D.h"
+
+#include <vector>
+#include "D_Transform2.h"
+#include "CD_Transform2.h"
+using namespace Diamond;
+
+/**
+ * Movers in parallel arrays, so that accelerating them is one pass
+ * over contiguous floats. Removing a mover moves the last one into its place.
+ */
+struct CDMovers {
+    static const uint32_t NO_INDEX = UINT32_MAX;
+
+    std::vector<DTransform2*> transforms;
+    std::vector<tD_pos> velocitiesX;
+    std::vector<tD_pos> velocitiesY;
+    std::vector<float> angularVelocities;
+    std::vector<tD_pos> accelerationsX;
+    std::vector<tD_pos> accelerationsY;
+    std::vector<float> angularAccelerations;
+    std::vector<tCD_Handle> handles;
+
+    // By handle.
+    std::vector<uint32_t> indices;
+    std::vector<tCD_Handle> freeHandles;
+
+    tCD_Handle add(DTransform2* transform) {
+        tCD_Handle mover;
+        if (!freeHandles.empty()) {
+            mover = freeHandles.back();
+            freeHandles.pop_back();
+        }
+        else {
+            mover = indices.size();
+            indices.push_back(NO_INDEX);
+        }
+
+        indices[mover] = handles.size();
+        transforms.push_back(transform);
+        velocitiesX.push_back(0);
+        velocitiesY.push_back(0);
+        angularVelocities.push_back(0);
+        accelerationsX.push_back(0);
+        accelerationsY.push_back(0);
+        angularAccelerations.push_back(0);
+        handles.push_back(mover);
+        return mover;
+    }
+
+    void remove(tCD_Handle mover) {
+        uint32_t index = indices[mover];
+        uint32_t last = handles.size() - 1;
+
+        transforms[index] = transforms[last];
+        velocitiesX[index] = velocitiesX[last];
+        velocitiesY[index] = velocitiesY[last];
+        angularVelocities[index] = angularVelocities[last];
+        accelerationsX[index] = accelerationsX[last];
+        accelerationsY[index] = accelerationsY[last];
+        angularAccelerations[index] = angularAccelerations[last];
+        handles[index] = handles[last];
+        indices[handles[index]] = index;
+
+        transforms.pop_back();
+        velocitiesX.pop_back();
+        velocitiesY.pop_back();
+        angularVelocities.pop_back();
+        accelerationsX.pop_back();
+        accelerationsY.pop_back();
+        angularAccelerations.pop_back();
+        handles.pop_back();
+
+        indices[mover] = NO_INDEX;
+        freeHandles.push_back(mover);
+    }
+};
+
+const uint32_t CDMovers::NO_INDEX;
+
+static CDMovers movers;
+
+void dMover2DDestroyAll() {
+    movers = CDMovers();
+}
+
+void dMover2DMakeMovers(const tCD_Handle* transforms, int count, tCD_Handle* newMovers) {
+    for (int i = 0; i < count; ++i) {
+        newMovers[i] = movers.add(dTransform2GetTransformPtr(transforms[i]).get());
+    }
+}
+
+void dMover2DDestroyMovers(const tCD_Handle* moversToDestroy, int count) {
+    for (int i = 0; i < count; ++i) {
+        movers.remove(moversToDestroy[i]);
+    }
+}
+
+void dMover2DGetVelocities(const tCD_Handle* handles, int count, tD_pos* velocities) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t index = movers.indices[handles[i]];
+        velocities[2 * i]     = movers.velocitiesX[index];
+        velocities[2 * i + 1] = movers.velocitiesY[index];
+    }
+}
+
+void dMover2DSetVelocities(const tCD_Handle* handles, int count, const tD_pos* velocities) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t index = movers.indices[handles[i]];
+        movers.velocitiesX[index] = velocities[2 * i];
+        movers.velocitiesY[index] = velocities[2 * i + 1];
+    }
+}
+
+void dMover2DGetAngularVelocities(const tCD_Handle* handles, int count,
+                                  float* angularVelocities) {
+    for (int i = 0; i < count; ++i) {
+        angularVelocities[i] = movers.angularVelocities[movers.indices[handles[i]]];
+    }
+}
+
+void dMover2DSetAngularVelocities(const tCD_Handle* handles, int count,
+                                  const float* angularVelocities) {
+    for (int i = 0; i < count; ++i) {
+        movers.angularVelocities[movers.indices[handles[i]]] = angularVelocities[i];
+    }
+}
+
+void dMover2DSetAccelerations(const tCD_Handle* handles, int count,
+                              const tD_pos* accelerations) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t index = movers.indices[handles[i]];
+        movers.accelerationsX[index] = accelerations[2 * i];
+        movers.accelerationsY[index] = accelerations[2 * i + 1];
+    }
+}
+
+void dMover2DSetAngularAccelerations(const tCD_Handle* handles, int count,
+                                     const float* angularAccelerations) {
+    for (int i = 0; i < count; ++i) {
+        movers.angularAccelerations[movers.indices[handles[i]]] = angularAccelerations[i];
+    }
+}
+
+void dMover2DUpdate(tD_delta delta) {
+    const size_t count = movers.handles.size();
+    const float dt = (float)delta;
+
+    tD_pos* vx = movers.velocitiesX.data();
+    tD_pos* vy = movers.velocitiesY.data();
+    float* w = movers.angularVelocities.data();
+    const tD_pos* ax = movers.accelerationsX.data();
+    const tD_pos* ay = movers.accelerationsY.data();
+    const float* aw = movers.angularAccelerations.data();
+
+    // semi-implicit Euler: accelerate first, then move by the new velocity
+    for (size_t i = 0; i < count; ++i) {
+        vx[i] += ax[i] * dt;
+        vy[i] += ay[i] * dt;
+        w[i] += aw[i] * dt;
+    }
+
+    DTransform2* const* transforms = movers.transforms.data();
+    for (size_t i = 0; i < count; ++i) {
+        DTransform2* transform = transforms[i];
+        transform->position.x += vx[i] * dt;
+        transform->position.y += vy[i] * dt;
+        transform->rotation += w[i] * dt;
+    }
+}
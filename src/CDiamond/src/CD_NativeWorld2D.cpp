@@ -0,0 +1,500 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "CD_NativeWorld2D.h"
+
+#include <algorithm>
+#include <iterator>
+#include "duMath.h"
+#include "CD_Physics2D.h"
+using namespace Diamond;
+
+static bool isStatic(const CDNativeShape2D& shape) {
+    return shape.bodyType == CD_BODY_STATIC;
+}
+
+// Pairs of static bodies never start or stop touching, so they aren't tested.
+static bool shouldTest(const CDNativeShape2D& a, const CDNativeShape2D& b) {
+    return !(isStatic(a) && isStatic(b));
+}
+
+// Narrowphase tests, on world shapes whose bounds overlap.
+// Polygons are convex, in either winding.
+
+// Returns whether an edge of a separates a from b.
+static bool edgeSeparates(const Vector2<tD_pos>* a, size_t numA,
+                          const Vector2<tD_pos>* b, size_t numB) {
+    for (size_t i = 0; i < numA; ++i) {
+        const auto& p = a[i];
+        const auto& q = a[(i + 1) % numA];
+        float axisX = q.y - p.y, axisY = p.x - q.x;
+
+        float minA = axisX * a[0].x + axisY * a[0].y, maxA = minA;
+        for (size_t j = 1; j < numA; ++j) {
+            float d = axisX * a[j].x + axisY * a[j].y;
+            minA = std::min(minA, d);
+            maxA = std::max(maxA, d);
+        }
+
+        float minB = axisX * b[0].x + axisY * b[0].y, maxB = minB;
+        for (size_t j = 1; j < numB; ++j) {
+            float d = axisX * b[j].x + axisY * b[j].y;
+            minB = std::min(minB, d);
+            maxB = std::max(maxB, d);
+        }
+
+        if (maxA < minB || maxB < minA) return true;
+    }
+    return false;
+}
+
+static bool polysOverlap(const Vector2<tD_pos>* a, size_t numA,
+                         const Vector2<tD_pos>* b, size_t numB) {
+    // a polygon without points has nothing to overlap with
+    if (numA == 0 || numB == 0) return false;
+    return !edgeSeparates(a, numA, b, numB) && !edgeSeparates(b, numB, a, numA);
+}
+
+static void boxPoints(const CDAABB2D& box, Vector2<tD_pos> points[4]) {
+    points[0] = Vector2<tD_pos>(box.minX, box.minY);
+    points[1] = Vector2<tD_pos>(box.maxX, box.minY);
+    points[2] = Vector2<tD_pos>(box.maxX, box.maxY);
+    points[3] = Vector2<tD_pos>(box.minX, box.maxY);
+}
+
+static bool circleBoxOverlap(const CDNativeShape2D& circle, const CDAABB2D& box) {
+    float x = std::max(box.minX, std::min(circle.worldCenter.x, box.maxX)) - circle.worldCenter.x;
+    float y = std::max(box.minY, std::min(circle.worldCenter.y, box.maxY)) - circle.worldCenter.y;
+    return x * x + y * y <= circle.worldRadius * circle.worldRadius;
+}
+
+static bool circlePolyOverlap(const CDNativeShape2D& circle,
+                              const Vector2<tD_pos>* points, size_t numPoints) {
+    if (numPoints == 0) return false;
+
+    const auto& c = circle.worldCenter;
+    float radiusSq = circle.worldRadius * circle.worldRadius;
+
+    // inside if on the same side of every edge
+    bool left = false, right = false;
+    for (size_t i = 0; i < numPoints; ++i) {
+        const auto& p = points[i];
+        const auto& q = points[(i + 1) % numPoints];
+        float ex = q.x - p.x, ey = q.y - p.y;
+
+        if (Math::dist2SegmentPoint(p, q, c) <= radiusSq) return true;
+
+        float cross = ex * (c.y - p.y) - ey * (c.x - p.x);
+        if (cross > 0) left = true;
+        else           right = true;
+    }
+    return !(left && right);
+}
+
+static bool shapesOverlap(const CDNativeShape2D& a, const CDNativeShape2D& b) {
+    // order the pair by type to halve the cases
+    if (a.type > b.type) return shapesOverlap(b, a);
+
+    Vector2<tD_pos> box[4];
+    switch (a.type) {
+        case CD_COLLIDER_AABB:
+            switch (b.type) {
+                case CD_COLLIDER_AABB:
+                    return true; // the bounds are the boxes
+                case CD_COLLIDER_CIRCLE:
+                    return circleBoxOverlap(b, a.bounds);
+                default:
+                    boxPoints(a.bounds, box);
+                    return polysOverlap(box, 4, b.worldPoints.data(), b.worldPoints.size());
+            }
+        case CD_COLLIDER_CIRCLE:
+            if (b.type == CD_COLLIDER_CIRCLE) {
+                float x = a.worldCenter.x - b.worldCenter.x;
+                float y = a.worldCenter.y - b.worldCenter.y;
+                float reach = a.worldRadius + b.worldRadius;
+                return x * x + y * y <= reach * reach;
+            }
+            return circlePolyOverlap(a, b.worldPoints.data(), b.worldPoints.size());
+        default:
+            return polysOverlap(a.worldPoints.data(), a.worldPoints.size(),
+                                b.worldPoints.data(), b.worldPoints.size());
+    }
+}
+
+
+void CDNativeAABBCollider2D::setLayer(CollisionLayer layer) {
+    world->setFilter(shape, layer, shape.category, shape.mask);
+}
+
+void CDNativeAABBCollider2D::setOrigin(const Vector2<tD_pos>& origin) {
+    shape.origin = origin;
+    world->refresh(shape);
+}
+
+void CDNativeAABBCollider2D::setDims(const Vector2<tD_pos>& dims) {
+    shape.dims = dims;
+    world->refresh(shape);
+}
+
+void CDNativeCircleCollider::setLayer(CollisionLayer layer) {
+    world->setFilter(shape, layer, shape.category, shape.mask);
+}
+
+void CDNativeCircleCollider::setRadius(tD_pos radius) {
+    shape.radius = radius;
+    world->refresh(shape);
+}
+
+void CDNativeCircleCollider::setCenter(const Vector2<tD_pos>& center) {
+    shape.origin = center;
+    world->refresh(shape);
+}
+
+void CDNativePolyCollider::setLayer(CollisionLayer layer) {
+    world->setFilter(shape, layer, shape.category, shape.mask);
+}
+
+void CDNativePolyCollider::setPoints(const tD_pos* xy, size_t count) {
+    if (count < 3) return;
+
+    shape.points.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        shape.points[i] = Vector2<tD_pos>(xy[2 * i], xy[2 * i + 1]);
+    }
+    world->refresh(shape);
+}
+
+
+void CDNativeWorld2D::BodyDeleter::free(void* body) const {
+    world.destroyBody(static_cast<CDNativeBody2D*>(static_cast<Rigidbody2D*>(body)));
+}
+
+CDNativeWorld2D::CDNativeWorld2D()
+    : bodyPool(256), aabbPool(256), circlePool(256), polyPool(64),
+      bodyDeleter(*this),
+      aabbDeleter(*this, aabbPool),
+      circleDeleter(*this, circlePool),
+      polyDeleter(*this, polyPool) {
+    allLayersCollideOn();
+}
+
+bool CDNativeWorld2D::init(const Config&) {
+    return true;
+}
+
+void CDNativeWorld2D::setLayersCollide(CollisionLayer layer1,
+                                       CollisionLayer layer2,
+                                       bool collides) {
+    layerMatrix[layer1][layer2] = collides;
+    layerMatrix[layer2][layer1] = collides;
+    refilterAll = true;
+}
+
+void CDNativeWorld2D::allLayersCollideOn() {
+    for (auto& layers : layerMatrix) layers.set();
+    refilterAll = true;
+}
+
+void CDNativeWorld2D::allLayersCollideOff() {
+    for (auto& layers : layerMatrix) layers.reset();
+    refilterAll = true;
+}
+
+void CDNativeWorld2D::setThreadPool(CDThreadPool* pool, size_t minPerRange) {
+    this->pool = pool;
+    this->minPerRange = minPerRange;
+}
+
+template <typename F>
+void CDNativeWorld2D::forRanges(size_t count, F fn) {
+    if (pool)
+        pool->parallelFor(count, minPerRange, fn);
+    else
+        fn(0, count);
+}
+
+void CDNativeWorld2D::update(tD_delta delta_ms) {
+    forRanges(bodies.size(), [this, delta_ms](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto body = bodies[i];
+            body->transform->position += body->velocity * (tD_pos)delta_ms;
+            body->transform->rotation += body->angVelocity * delta_ms;
+        }
+    });
+
+    // shapes only read their bodies' transforms, so they can be
+    // updated in parallel once every body has moved
+    oldBounds.resize(shapes.size());
+    forRanges(shapes.size(), [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            oldBounds[i] = shapes[i]->bounds;
+            updateWorldShape(*shapes[i]);
+        }
+    });
+
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        auto shape = shapes[i];
+        const CDAABB2D& old = oldBounds[i];
+        if (tree.move(shape->proxy, shape->bounds,
+                      shape->bounds.minX - old.minX, shape->bounds.minY - old.minY)) {
+            movedProxies.push_back(shape->proxy);
+        }
+    }
+
+    updatePairs();
+
+    for (auto& pair : pairs) {
+        auto a = static_cast<CDNativeShape2D*>(tree.getUserData(pair.first));
+        auto b = static_cast<CDNativeShape2D*>(tree.getUserData(pair.second));
+        if (!a->bounds.overlaps(b->bounds) ||
+            !shapesOverlap(*a, *b)) {
+            continue;
+        }
+
+        if (a->onCollision) a->onCollision(b->parent);
+        if (b->onCollision) b->onCollision(a->parent);
+    }
+}
+
+void CDNativeWorld2D::updatePairs() {
+    if (refilterAll) {
+        // any pair may have started or stopped passing
+        for (auto shape : shapes) movedProxies.push_back(shape->proxy);
+        refilterPairs = true;
+        refilterAll = false;
+    }
+
+    // drop pairs that have moved apart or no longer pass their filters
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+        [this](const std::pair<int, int>& pair) {
+            if (refilterPairs &&
+                !filtersPass(*static_cast<const CDNativeShape2D*>(tree.getUserData(pair.first)),
+                             *static_cast<const CDNativeShape2D*>(tree.getUserData(pair.second)))) {
+                return true;
+            }
+            return !tree.getFatAABB(pair.first).overlaps(tree.getFatAABB(pair.second));
+        }), pairs.end());
+    refilterPairs = false;
+
+    if (movedProxies.empty()) return;
+
+    // look up what the proxies that moved in the tree now overlap
+    newPairs.clear();
+    for (int proxy : movedProxies) {
+        auto shape = static_cast<const CDNativeShape2D*>(tree.getUserData(proxy));
+        tree.query(tree.getFatAABB(proxy), [this, proxy, shape](int other) {
+            if (other == proxy) return true;
+            auto otherShape = static_cast<const CDNativeShape2D*>(tree.getUserData(other));
+            if (shouldTest(*shape, *otherShape) && filtersPass(*shape, *otherShape)) {
+                newPairs.push_back(std::minmax(proxy, other));
+            }
+            return true;
+        });
+    }
+    movedProxies.clear();
+
+    std::sort(newPairs.begin(), newPairs.end());
+    size_t numPairs = pairs.size();
+    pairs.insert(pairs.end(), newPairs.begin(), newPairs.end());
+    std::inplace_merge(pairs.begin(), pairs.begin() + numPairs, pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+DumbPtr<Rigidbody2D> CDNativeWorld2D::makeRigidbody(DTransform2& transform) {
+    return makeRigidbody(transform, CDRigidbodyDef2D());
+}
+
+DumbPtr<Rigidbody2D> CDNativeWorld2D::makeRigidbody(DTransform2& transform,
+                                                    const CDRigidbodyDef2D& def) {
+    auto body = bodyPool.make(&transform, def.type);
+    if (def.type != CD_BODY_STATIC) {
+        body->index = bodies.size();
+        bodies.push_back(body);
+    }
+    return DumbPtr<Rigidbody2D>(body, &bodyDeleter);
+}
+
+void CDNativeWorld2D::destroyBody(CDNativeBody2D* body) {
+    if (body->type != CD_BODY_STATIC) {
+        bodies[body->index] = bodies.back();
+        bodies[body->index]->index = body->index;
+        bodies.pop_back();
+    }
+    bodyPool.free(body);
+}
+
+void CDNativeWorld2D::initShape(CDNativeShape2D& shape,
+                                int type,
+                                const Rigidbody2D* body,
+                                void* parent,
+                                const std::function<void(void* other)>& onCollision,
+                                CollisionLayer layer) {
+    shape.type = type;
+    shape.layer = layer;
+    shape.category = CD_CATEGORY_DEFAULT;
+    shape.mask = CD_MASK_ALL;
+    shape.body = static_cast<const CDNativeBody2D*>(body);
+    shape.bodyType = shape.body ? shape.body->getType() : CD_BODY_STATIC;
+    shape.parent = parent;
+    shape.onCollision = onCollision;
+    shape.radius = 0;
+}
+
+void CDNativeWorld2D::addShape(CDNativeShape2D& shape) {
+    updateWorldShape(shape);
+    shape.proxy = tree.insert(shape.bounds, &shape);
+    auto& list = isStatic(shape) ? staticShapes : shapes;
+    shape.index = list.size();
+    list.push_back(&shape);
+    movedProxies.push_back(shape.proxy);
+}
+
+void CDNativeWorld2D::removeShape(CDNativeShape2D& shape) {
+    int proxy = shape.proxy;
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+        [proxy](const std::pair<int, int>& pair) {
+            return pair.first == proxy || pair.second == proxy;
+        }), pairs.end());
+    movedProxies.erase(std::remove(movedProxies.begin(), movedProxies.end(), proxy),
+                       movedProxies.end());
+    tree.remove(proxy);
+
+    auto& list = isStatic(shape) ? staticShapes : shapes;
+    list[shape.index] = list.back();
+    list[shape.index]->index = shape.index;
+    list.pop_back();
+}
+
+void CDNativeWorld2D::refresh(CDNativeShape2D& shape) {
+    CDAABB2D old = shape.bounds;
+    updateWorldShape(shape);
+    if (tree.move(shape.proxy, shape.bounds,
+                  shape.bounds.minX - old.minX, shape.bounds.minY - old.minY)) {
+        movedProxies.push_back(shape.proxy);
+    }
+}
+
+void CDNativeWorld2D::setFilter(CDNativeShape2D& shape, CollisionLayer layer,
+                                uint32_t category, uint32_t mask) {
+    shape.layer = layer;
+    shape.category = category;
+    shape.mask = mask;
+    // look up the shape's pairs again, and drop the ones that no longer pass
+    movedProxies.push_back(shape.proxy);
+    refilterPairs = true;
+}
+
+void CDNativeWorld2D::refreshBody(const Rigidbody2D* body) {
+    for (auto shape : staticShapes) {
+        if (shape->body == body) refresh(*shape);
+    }
+}
+
+void CDNativeWorld2D::updateWorldShape(CDNativeShape2D& shape) {
+    Vector2<tD_pos> position(0, 0);
+    tD_rot rotation = 0;
+    Vector2<tD_real> scale(1, 1);
+    if (shape.body) {
+        position = shape.body->transform->position;
+        rotation = shape.body->transform->rotation;
+        scale = shape.body->transform->scale;
+    }
+
+    switch (shape.type) {
+        case CD_COLLIDER_AABB: {
+            float minX = position.x + shape.origin.x * scale.x;
+            float minY = position.y + shape.origin.y * scale.y;
+            shape.bounds = {minX, minY,
+                            minX + shape.dims.x * scale.x,
+                            minY + shape.dims.y * scale.y};
+            break;
+        }
+        case CD_COLLIDER_CIRCLE: {
+            tD_pos m[2][2];
+            Math::transMat<tD_pos>(Math::deg2rad(rotation), scale.x, scale.y, m);
+            shape.worldCenter = shape.origin.mul(m) + position;
+            shape.worldRadius = shape.radius * scale.x;
+            shape.bounds = {shape.worldCenter.x - shape.worldRadius,
+                            shape.worldCenter.y - shape.worldRadius,
+                            shape.worldCenter.x + shape.worldRadius,
+                            shape.worldCenter.y + shape.worldRadius};
+            break;
+        }
+        default: {
+            tD_pos m[2][2];
+            Math::transMat<tD_pos>(Math::deg2rad(rotation), scale.x, scale.y, m);
+            shape.worldPoints.resize(shape.points.size());
+            shape.bounds = {position.x, position.y, position.x, position.y};
+            for (size_t i = 0; i < shape.points.size(); ++i) {
+                auto& point = shape.worldPoints[i];
+                point = shape.points[i].mul(m) + position;
+                if (i == 0) {
+                    shape.bounds = {point.x, point.y, point.x, point.y};
+                    continue;
+                }
+                shape.bounds.minX = std::min<float>(shape.bounds.minX, point.x);
+                shape.bounds.minY = std::min<float>(shape.bounds.minY, point.y);
+                shape.bounds.maxX = std::max<float>(shape.bounds.maxX, point.x);
+                shape.bounds.maxY = std::max<float>(shape.bounds.maxY, point.y);
+            }
+            break;
+        }
+    }
+}
+
+DumbPtr<AABBCollider2D> CDNativeWorld2D::makeAABBCollider(
+        const Rigidbody2D* body,
+        void* parent,
+        const std::function<void(void* other)>& onCollision,
+        const Vector2<tD_pos>& dims,
+        const Vector2<tD_pos>& origin,
+        CollisionLayer layer) {
+    auto collider = aabbPool.make(this);
+    initShape(collider->shape, CD_COLLIDER_AABB, body, parent, onCollision, layer);
+    collider->shape.origin = origin;
+    collider->shape.dims = dims;
+    addShape(collider->shape);
+    return DumbPtr<AABBCollider2D>(collider, &aabbDeleter);
+}
+
+DumbPtr<CircleCollider> CDNativeWorld2D::makeCircleCollider(
+        const Rigidbody2D* body,
+        void* parent,
+        const std::function<void(void* other)>& onCollision,
+        tD_pos radius,
+        const Vector2<tD_pos>& center,
+        CollisionLayer layer) {
+    auto collider = circlePool.make(this);
+    initShape(collider->shape, CD_COLLIDER_CIRCLE, body, parent, onCollision, layer);
+    collider->shape.origin = center;
+    collider->shape.radius = radius;
+    addShape(collider->shape);
+    return DumbPtr<CircleCollider>(collider, &circleDeleter);
+}
+
+DumbPtr<PolyCollider> CDNativeWorld2D::makePolyCollider(
+        const Rigidbody2D* body,
+        void* parent,
+        const std::function<void(void* other)>& onCollision,
+        const PointList2D& points,
+        CollisionLayer layer) {
+    auto collider = polyPool.make(this);
+    initShape(collider->shape, CD_COLLIDER_POLY, body, parent, onCollision, layer);
+    collider->shape.points = points;
+    addShape(collider->shape);
+    return DumbPtr<PolyCollider>(collider, &polyDeleter);
+}
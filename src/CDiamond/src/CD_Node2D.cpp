@@ -0,0 +1,96 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "CD_Node2D.h"
+
+#include "CD_NodeTree2D.h"
+#include "CD_Transform2.h"
+using namespace Diamond;
+
+static CDNodeTree2D* tree = nullptr;
+
+bool dNode2DInit() {
+    if (!tree) tree = new CDNodeTree2D();
+    return true;
+}
+
+void dNode2DDestroy() {
+    delete tree;
+    tree = nullptr;
+}
+
+tCD_Handle dNode2DMakeNode(tCD_Handle transform) {
+    return tree->makeNode(dTransform2GetTransformPtr(transform).get());
+}
+
+void dNode2DDestroyNode(tCD_Handle node) {
+    tree->destroyNode(node);
+}
+
+bool dNode2DAddChild(tCD_Handle parent, tCD_Handle child) {
+    return tree->addChild(parent, child);
+}
+
+bool dNode2DRemoveChild(tCD_Handle parent, tCD_Handle child) {
+    return tree->removeChild(parent, child);
+}
+
+tCD_Handle dNode2DGetParent(tCD_Handle node) {
+    return tree->getParent(node);
+}
+
+dTransform2f dNode2DGetLocalTransform(tCD_Handle node) {
+    auto& local = tree->getLocalTransform(node);
+    return {{local.position.x, local.position.y},
+            local.rotation,
+            {local.scale.x, local.scale.y}};
+}
+
+void dNode2DSetLocalTransform(tCD_Handle node,
+                              float positionX, float positionY,
+                              float rotation,
+                              float scaleX, float scaleY) {
+    tree->setLocalTransform(node, DTransform2(Vector2<tD_pos>(positionX, positionY),
+                                              rotation,
+                                              Vector2<tD_real>(scaleX, scaleY)));
+}
+
+static_assert(sizeof(Vector2<tD_pos>) == 2 * sizeof(float),
+              "points are passed as pairs of floats");
+
+void dNode2DLocalToWorldPoints(tCD_Handle node, const float* in,
+                               float* out, int count) {
+    tree->localToWorldSpace(node, reinterpret_cast<const Vector2<tD_pos>*>(in),
+                            reinterpret_cast<Vector2<tD_pos>*>(out), count);
+}
+
+void dNode2DWorldToLocalPoints(tCD_Handle node, const float* in,
+                               float* out, int count) {
+    tree->worldToLocalSpace(node, reinterpret_cast<const Vector2<tD_pos>*>(in),
+                            reinterpret_cast<Vector2<tD_pos>*>(out), count);
+}
+
+void dNode2DUpdate() {
+    if (tree) tree->update();
+}
+
+CDNodeTree2D& dNode2DGetTree() {
+    return *tree;
+}
+
+void dNode2DSetThreadPool(CDThreadPool* pool, size_t minPerRange) {
+    if (tree) tree->setThreadPool(pool, minPerRange);
+}
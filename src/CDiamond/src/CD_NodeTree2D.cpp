@@ -0,0 +1,283 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "CD_NodeTree2D.h"
+
+#include <algorithm>
+#include "duMath.h"
+#include "CD_ThreadPool.h"
+using namespace Diamond;
+
+const uint32_t CDNodeTree2D::NO_SLOT;
+
+static Matrix<tD_real, 2, 2> worldMatrix(const DTransform2& world) {
+    return Math::transMat((tD_real)Math::deg2rad(world.rotation),
+                          (tD_real)world.scale.x, (tD_real)world.scale.y);
+}
+
+static bool moved(const DTransform2& a, const DTransform2& b) {
+    return a.position.x != b.position.x || a.position.y != b.position.y ||
+           a.rotation != b.rotation ||
+           a.scale.x != b.scale.x || a.scale.y != b.scale.y;
+}
+
+// The same conversions as Node2D's, given the parent's world transform
+// and its matrix, or the matrix's inverse going from world to local.
+
+static DTransform2 localToWorld(const DTransform2& local,
+                                const DTransform2& parent,
+                                const Matrix<tD_real, 2, 2>& parentMat) {
+    DTransform2 world;
+    world.position = local.position.mul(parentMat.m) + parent.position;
+    world.rotation = local.rotation + parent.rotation;
+    world.scale = Vector2<tD_real>(local.scale).scalar(parent.scale);
+    return world;
+}
+
+static DTransform2 worldToLocal(const DTransform2& world,
+                                const DTransform2& parent,
+                                const Matrix<tD_real, 2, 2>& parentInvMat) {
+    DTransform2 local;
+    local.position = (world.position - parent.position).mul(parentInvMat.m);
+    local.rotation = world.rotation - parent.rotation;
+    local.scale = Vector2<tD_real>(world.scale).scalar(1.0 / parent.scale.x,
+                                                       1.0 / parent.scale.y);
+    return local;
+}
+
+// Reorders v so that v[i] becomes what was v[from[i]].
+template <typename T>
+static void gather(std::vector<T>& v, const std::vector<uint32_t>& from) {
+    std::vector<T> gathered;
+    gathered.reserve(from.size());
+    for (uint32_t slot : from) {
+        gathered.push_back(v[slot]);
+    }
+    v.swap(gathered);
+}
+
+tCD_Handle CDNodeTree2D::makeNode(DTransform2* transform) {
+    tCD_Handle node;
+    if (!freeHandles.empty()) {
+        node = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else {
+        node = slots.size();
+        slots.push_back(NO_SLOT);
+        parents.push_back(CD_INVALID_HANDLE);
+        children.emplace_back();
+    }
+
+    slots[node] = transforms.size();
+    parents[node] = CD_INVALID_HANDLE;
+    transforms.push_back(transform);
+    parentSlots.push_back(-1);
+    locals.push_back(*transform);
+    cachedWorlds.push_back(*transform);
+    mats.push_back(worldMatrix(*transform));
+    invMats.push_back(mats.back().inv());
+    dirty.push_back(0);
+    slotNodes.push_back(node);
+    return node;
+}
+
+void CDNodeTree2D::destroyNode(tCD_Handle node) {
+    detach(node);
+    for (tCD_Handle child : children[node]) {
+        uint32_t slot = slots[child];
+        parents[child] = CD_INVALID_HANDLE;
+        parentSlots[slot] = -1;
+        locals[slot] = cachedWorlds[slot];
+    }
+    children[node].clear();
+
+    // the slot is dropped when the order is next rebuilt
+    uint32_t slot = slots[node];
+    transforms[slot] = nullptr;
+    slotNodes[slot] = CD_INVALID_HANDLE;
+    slots[node] = NO_SLOT;
+    freeHandles.push_back(node);
+    orderDirty = true;
+}
+
+bool CDNodeTree2D::addChild(tCD_Handle parent, tCD_Handle child) {
+    for (tCD_Handle ancestor = parent; ancestor != CD_INVALID_HANDLE; ancestor = parents[ancestor]) {
+        if (ancestor == child) return false;
+    }
+
+    detach(child);
+    parents[child] = parent;
+    children[parent].push_back(child);
+
+    uint32_t parentSlot = slots[parent], slot = slots[child];
+    parentSlots[slot] = parentSlot;
+    locals[slot] = worldToLocal(*transforms[slot], cachedWorlds[parentSlot], invMats[parentSlot]);
+    if (slot < parentSlot) orderDirty = true;
+    subtreesContiguous = false;
+    return true;
+}
+
+bool CDNodeTree2D::removeChild(tCD_Handle parent, tCD_Handle child) {
+    if (parents[child] != parent || parent == CD_INVALID_HANDLE) return false;
+    detach(child);
+    return true;
+}
+
+const DTransform2& CDNodeTree2D::getLocalTransform(tCD_Handle node) const {
+    return locals[slots[node]];
+}
+
+void CDNodeTree2D::setLocalTransform(tCD_Handle node, const DTransform2& local) {
+    uint32_t slot = slots[node];
+    locals[slot] = local;
+    dirty[slot] = 1;
+}
+
+void CDNodeTree2D::localToWorldSpace(tCD_Handle node, const Vector2<tD_pos>* in,
+                                     Vector2<tD_pos>* out, size_t count) const {
+    uint32_t slot = slots[node];
+    const auto& origin = cachedWorlds[slot].position;
+    const auto& m = mats[slot].m;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = in[i].mul(m) + origin;
+    }
+}
+
+void CDNodeTree2D::worldToLocalSpace(tCD_Handle node, const Vector2<tD_pos>* in,
+                                     Vector2<tD_pos>* out, size_t count) const {
+    uint32_t slot = slots[node];
+    const auto& origin = cachedWorlds[slot].position;
+    const auto& m = invMats[slot].m;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = (in[i] - origin).mul(m);
+    }
+}
+
+void CDNodeTree2D::setThreadPool(CDThreadPool* pool, size_t minPerRange) {
+    this->pool = pool;
+    this->minPerRange = minPerRange;
+}
+
+template <typename F>
+void CDNodeTree2D::forRanges(size_t count, F fn) {
+    if (pool)
+        pool->parallelFor(count, minPerRange, fn);
+    else
+        fn(0, count);
+}
+
+void CDNodeTree2D::update() {
+    size_t n = transforms.size();
+    // only pay for laying subtrees out again when the sweep will be split
+    bool split = pool && n / std::max<size_t>(minPerRange, 1) > 1;
+    if (orderDirty || (split && !subtreesContiguous)) rebuildOrder();
+    n = transforms.size();
+
+    // take in moves from outside, in the parents' spaces as of the last update
+    forRanges(n, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const DTransform2& world = *transforms[i];
+            if (dirty[i] || !moved(world, cachedWorlds[i])) continue;
+            int32_t parent = parentSlots[i];
+            locals[i] = parent < 0 ? world
+                                   : worldToLocal(world, cachedWorlds[parent], invMats[parent]);
+            dirty[i] = 1;
+        }
+    });
+
+    forRanges(n, [this, n](size_t begin, size_t end) {
+        // each range takes the subtrees of the roots in it, so that no
+        // two ranges touch the same subtree. Slot 0 is always a root,
+        // so one range over every slot takes them all.
+        while (begin < n && parentSlots[begin] >= 0) ++begin;
+        while (end < n && parentSlots[end] >= 0) ++end;
+
+        // parents come first, so their flags and world transforms are final
+        // by the time their children are reached
+        for (size_t i = begin; i < end; ++i) {
+            int32_t parent = parentSlots[i];
+            if (parent >= 0 && dirty[parent]) dirty[i] = 1;
+            if (!dirty[i]) continue;
+
+            DTransform2 world = parent < 0 ? locals[i]
+                                           : localToWorld(locals[i], cachedWorlds[parent], mats[parent]);
+            // a sin and a cos, only if needed
+            if (world.rotation != cachedWorlds[i].rotation ||
+                world.scale.x != cachedWorlds[i].scale.x ||
+                world.scale.y != cachedWorlds[i].scale.y) {
+                mats[i] = worldMatrix(world);
+                invMats[i] = mats[i].inv();
+            }
+            *transforms[i] = world;
+            cachedWorlds[i] = world;
+        }
+    });
+
+    std::fill(dirty.begin(), dirty.end(), 0);
+}
+
+// Makes child a root, keeping its world transform.
+void CDNodeTree2D::detach(tCD_Handle child) {
+    tCD_Handle parent = parents[child];
+    if (parent == CD_INVALID_HANDLE) return;
+
+    auto& siblings = children[parent];
+    siblings.erase(std::find(siblings.begin(), siblings.end(), child));
+    parents[child] = CD_INVALID_HANDLE;
+
+    uint32_t slot = slots[child];
+    parentSlots[slot] = -1;
+    locals[slot] = cachedWorlds[slot];
+    subtreesContiguous = false;
+}
+
+// Lays the nodes out again depth first, keeping roots in their order,
+// and drops destroyed nodes' slots.
+void CDNodeTree2D::rebuildOrder() {
+    std::vector<uint32_t> from;
+    from.reserve(size());
+    std::vector<tCD_Handle> stack;
+    for (tCD_Handle root : slotNodes) {
+        if (root == CD_INVALID_HANDLE || parents[root] != CD_INVALID_HANDLE) continue;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            tCD_Handle node = stack.back();
+            stack.pop_back();
+            from.push_back(slots[node]);
+            stack.insert(stack.end(), children[node].rbegin(), children[node].rend());
+        }
+    }
+
+    gather(transforms, from);
+    gather(locals, from);
+    gather(cachedWorlds, from);
+    gather(mats, from);
+    gather(invMats, from);
+    gather(dirty, from);
+    gather(slotNodes, from);
+
+    for (uint32_t slot = 0; slot < slotNodes.size(); ++slot) {
+        slots[slotNodes[slot]] = slot;
+    }
+    parentSlots.resize(slotNodes.size());
+    for (uint32_t slot = 0; slot < slotNodes.size(); ++slot) {
+        tCD_Handle parent = parents[slotNodes[slot]];
+        parentSlots[slot] = parent == CD_INVALID_HANDLE ? -1 : slots[parent];
+    }
+    orderDirty = false;
+    subtreesContiguous = true;
+}
@@ -16,29 +16,340 @@
 
 #include "CD_Physics2D.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
 #include "duSwapVector.h"
+#include "D_Log.h"
+#include "CD_BodyTable.h"
 #include "CD_Engine2D.h"
+#include "CD_NativeWorld2D.h"
+#include "CD_Node2D.h"
+#include "CD_ThreadPool.h"
 #include "CD_Transform2.h"
 #include "CD_Util.h" // for pointlist
 using namespace Diamond;
 
-static PhysicsWorld2D *physWorld = nullptr;
+struct CDContact2D {
+    const CDCollider2D* a;
+    const CDCollider2D* b;
+
+    bool operator<(const CDContact2D& other) const {
+        return a->id < other.a->id || (a->id == other.a->id && b->id < other.b->id);
+    }
+    bool operator==(const CDContact2D& other) const {
+        return a == other.a && b == other.b;
+    }
+};
+
+/**
+ * Wraps the engine's physics world to turn the collision callbacks
+ * made during each step into enter/stay/exit events.
+ * Contacts are recorded into buffers that keep their capacity
+ * between steps, so recording doesn't allocate once they've grown.
+ *
+ * Also steps the world by a fixed timestep if configured to
+ * (see dEngine2DConfigurePhysics), in which case collision events
+ * cover all the steps taken in a frame.
+ *
+ * With more than one physics thread configured
+ * (see dEngine2DConfigurePhysicsThreads), owns the pool of extra
+ * threads that transform syncing, node updates (if nodes were
+ * initialized first) and the native world run on.
+ */
+class CDPhysicsWorld2D : public PhysicsWorld2D {
+public:
+    CDPhysicsWorld2D(PhysicsWorld2D* world, const CDPhysicsConfig2D& config)
+        : world(world), nativeWorld(dynamic_cast<CDNativeWorld2D*>(world)),
+          config(config), accumulator(0) {
+        contacts.reserve(INITIAL_CONTACTS);
+        prevContacts.reserve(INITIAL_CONTACTS);
+        collisionEvents.reserve(INITIAL_CONTACTS);
+
+        if (config.numThreads > 1) {
+            // the calling thread takes a range too
+            pool.reset(new CDThreadPool(config.numThreads - 1));
+            size_t minPerRange = std::max(config.minBodiesPerThread, 1);
+            bodies.setThreadPool(pool.get(), minPerRange);
+            if (nativeWorld) nativeWorld->setThreadPool(pool.get(), minPerRange);
+            dNode2DSetThreadPool(pool.get(), minPerRange);
+        }
+    }
+
+    ~CDPhysicsWorld2D() {
+        // the native world and node tree outlive this
+        if (nativeWorld) nativeWorld->setThreadPool(nullptr, 0);
+        dNode2DSetThreadPool(nullptr, 0);
+    }
+
+    PhysicsWorld2D* wrapped() const { return world; }
+    CDNativeWorld2D* native() const { return nativeWorld; }
+
+    // the convenience overloads that the overrides below would hide
+    using PhysicsWorld2D::makeRigidbody;
+    using PhysicsWorld2D::makeAABBCollider;
+    using PhysicsWorld2D::makeCircleCollider;
+
+    bool init(const Config& config) override {
+        return world->init(config);
+    }
+
+    void setLayersCollide(CollisionLayer layer1,
+                          CollisionLayer layer2,
+                          bool collides) override {
+        world->setLayersCollide(layer1, layer2, collides);
+    }
+
+    bool doLayersCollide(CollisionLayer layer1,
+                         CollisionLayer layer2) const override {
+        return world->doLayersCollide(layer1, layer2);
+    }
+
+    void allLayersCollideOn() override { world->allLayersCollideOn(); }
+    void allLayersCollideOff() override { world->allLayersCollideOff(); }
+
+    void update(tD_delta delta_ms) override {
+        contacts.clear();
+
+        if (config.fixedStep <= 0) {
+            if (delta_ms > 0) ++version;
+            world->update(delta_ms);
+            makeEvents();
+            return;
+        }
+
+        if (config.interpolate) bodies.restoreTransforms();
+
+        accumulator += delta_ms;
+        int steps = 0;
+        while (accumulator >= config.fixedStep && steps < config.maxSubsteps) {
+            if (config.interpolate) bodies.savePrevious();
+            world->update(config.fixedStep);
+            if (config.interpolate) bodies.pullTransforms();
+
+            accumulator -= config.fixedStep;
+            ++steps;
+        }
+
+        // drop the time that the substep cap didn't allow for,
+        // rather than falling further behind every frame
+        accumulator %= config.fixedStep;
+
+        if (config.interpolate) bodies.interpolate((float)accumulator / config.fixedStep);
+
+        // nothing moved, touched or stopped touching without a step
+        if (steps > 0) {
+            ++version;
+            makeEvents();
+        }
+        else {
+            collisionEvents.clear();
+        }
+    }
+
+    void trackBody(tCD_Handle rigidbody, DTransform2* transform) {
+        bodies.add(rigidbody, transform);
+    }
+
+    void untrackBody(tCD_Handle rigidbody) {
+        bodies.remove(rigidbody);
+    }
+
+    DumbPtr<Rigidbody2D> makeRigidbody(DTransform2& transform) override {
+        return world->makeRigidbody(transform);
+    }
+
+    // only the native world knows body types
+    DumbPtr<Rigidbody2D> makeRigidbody(DTransform2& transform, const CDRigidbodyDef2D& def) {
+        if (nativeWorld)
+            return nativeWorld->makeRigidbody(transform, def);
+        return world->makeRigidbody(transform);
+    }
+
+    void refreshStaticBody(const Rigidbody2D* body) {
+        if (nativeWorld)
+            nativeWorld->refreshBody(body);
+    }
+
+    DumbPtr<AABBCollider2D> makeAABBCollider(
+            const Rigidbody2D* body,
+            void* parent,
+            const std::function<void(void* other)>& onCollision,
+            const Vector2<tD_pos>& dims,
+            const Vector2<tD_pos>& origin = Vector2<tD_pos>(0, 0),
+            CollisionLayer layer = 0) override {
+        return world->makeAABBCollider(body, parent, onCollision, dims, origin, layer);
+    }
+
+    DumbPtr<CircleCollider> makeCircleCollider(
+            const Rigidbody2D* body,
+            void* parent,
+            const std::function<void(void* other)>& onCollision,
+            tD_pos radius,
+            const Vector2<tD_pos>& center = Vector2<tD_pos>(0, 0),
+            CollisionLayer layer = 0) override {
+        return world->makeCircleCollider(body, parent, onCollision, radius, center, layer);
+    }
+
+    DumbPtr<PolyCollider> makePolyCollider(
+            const Rigidbody2D* body,
+            void* parent,
+            const std::function<void(void* other)>& onCollision,
+            const PointList2D& points,
+            CollisionLayer layer = 0) override {
+        return world->makePolyCollider(body, parent, onCollision, points, layer);
+    }
+
+    void addContact(const CDCollider2D* collider, const CDCollider2D* other) {
+        if (collider == other) return;
+        // the native world already filters by category and mask, Quantum2D doesn't
+        if (!(collider->category & other->mask) || !(other->category & collider->mask)) return;
+        if (collider->id < other->id)
+            contacts.push_back({collider, other});
+        else
+            contacts.push_back({other, collider});
+    }
+
+    // Drops the given collider's contacts so that
+    // it isn't reported as exiting after it's gone.
+    void forget(const CDCollider2D* collider) {
+        prevContacts.erase(std::remove_if(prevContacts.begin(), prevContacts.end(),
+            [collider](const CDContact2D& contact) {
+                return contact.a == collider || contact.b == collider;
+            }), prevContacts.end());
+    }
+
+    const std::vector<dCollisionEvent2D>& events() const { return collisionEvents; }
+
+    uint32_t version = 0;
+
+private:
+    static const size_t INITIAL_CONTACTS = 1024;
+
+    PhysicsWorld2D* world;
+    // world, if it's the native one
+    CDNativeWorld2D* nativeWorld;
+    CDPhysicsConfig2D config;
+    std::unique_ptr<CDThreadPool> pool;
+
+    // bodies made through CDiamond, by rigidbody handle
+    CDBodyTable bodies;
+    tD_delta accumulator;
+
+    std::vector<CDContact2D> contacts;
+    std::vector<CDContact2D> prevContacts;
+    std::vector<dCollisionEvent2D> collisionEvents;
+
+    void pushEvent(int state, const CDContact2D& contact) {
+        collisionEvents.push_back({state,
+                                   contact.a->type, contact.a->handle,
+                                   contact.b->type, contact.b->handle});
+    }
+
+    void makeEvents() {
+        // both colliders of a pair may report it
+        std::sort(contacts.begin(), contacts.end());
+        contacts.erase(std::unique(contacts.begin(), contacts.end()), contacts.end());
+
+        // both lists are sorted, so walk them together
+        collisionEvents.clear();
+        auto cur = contacts.begin();
+        auto prev = prevContacts.begin();
+        while (cur != contacts.end() || prev != prevContacts.end()) {
+            if (prev == prevContacts.end() || (cur != contacts.end() && *cur < *prev)) {
+                pushEvent(CD_COLLISION_ENTER, *cur++);
+            }
+            else if (cur == contacts.end() || *prev < *cur) {
+                pushEvent(CD_COLLISION_EXIT, *prev++);
+            }
+            else {
+                pushEvent(CD_COLLISION_STAY, *cur++);
+                ++prev;
+            }
+        }
+
+        prevContacts.swap(contacts);
+    }
+};
+
+static CDPhysicsWorld2D *physWorld = nullptr;
 static SwapVector<DumbPtr<Rigidbody2D>, tCD_Handle> rigidbodies;
+// CD_BODY_* by rigidbody handle
+static std::vector<int> rigidbodyTypes;
 static SwapVector<DumbPtr<AABBCollider2D>, tCD_Handle> aabbs;
 static SwapVector<DumbPtr<CircleCollider>, tCD_Handle> circles;
 static SwapVector<DumbPtr<PolyCollider>, tCD_Handle> polys;
+// rigidbody handles by poly collider handle, for remaking reshaped polys
+static std::vector<tCD_Handle> polyRigidbodies;
+
+// collider records by collider type and handle
+static std::vector<CDCollider2D*> colliderRecords[CD_NUM_COLLIDER_TYPES];
+static uint32_t nextColliderID = 0;
+
+static const dColliderFilter2D defaultFilter = {0, CD_CATEGORY_DEFAULT, CD_MASK_ALL};
+
+static CDCollider2D* makeColliderRecord(int type, const dColliderFilter2D& filter) {
+    ++physWorld->version;
+    return new CDCollider2D{type, CD_INVALID_HANDLE, nextColliderID++,
+                            filter.category, filter.mask};
+}
+
+// the native world's shape for the given collider
+static CDNativeShape2D& nativeShape(int type, tCD_Handle collider) {
+    switch (type) {
+        case CD_COLLIDER_AABB:
+            return static_cast<CDNativeAABBCollider2D*>(aabbs[collider].get())->shape;
+        case CD_COLLIDER_CIRCLE:
+            return static_cast<CDNativeCircleCollider*>(circles[collider].get())->shape;
+        default:
+            return static_cast<CDNativePolyCollider*>(polys[collider].get())->shape;
+    }
+}
+
+static std::function<void(void *other)> collisionCallback(const CDCollider2D* collider) {
+    return [collider](void *other) {
+        // other is the parent of the collider that was hit
+        if (other && physWorld)
+            physWorld->addContact(collider, static_cast<const CDCollider2D*>(other));
+    };
+}
+
+static tCD_Handle registerCollider(CDCollider2D* collider, tCD_Handle handle) {
+    auto& records = colliderRecords[collider->type];
+    if (records.size() <= (size_t)handle) records.resize(handle + 1, nullptr);
+    records[handle] = collider;
+    collider->handle = handle;
+
+    // the colliders were made with their layer, but the native world
+    // needs categories and masks to filter pairs before testing them
+    if (physWorld->native() &&
+        (collider->category != CD_CATEGORY_DEFAULT || collider->mask != CD_MASK_ALL)) {
+        auto& shape = nativeShape(collider->type, handle);
+        physWorld->native()->setFilter(shape, shape.layer, collider->category, collider->mask);
+    }
+    return handle;
+}
+
+static void destroyColliderRecord(int type, tCD_Handle handle) {
+    auto& collider = colliderRecords[type][handle];
+    physWorld->forget(collider);
+    ++physWorld->version;
+    delete collider;
+    collider = nullptr;
+}
 
 bool dPhysics2DInit() {
     auto engine = dEngine2DGetEngine();
-    if (engine) {
-        physWorld = engine->getPhysWorld();
+    if (engine && engine->getPhysWorld()) {
+        physWorld = new CDPhysicsWorld2D(engine->getPhysWorld(),
+                                         dEngine2DGetPhysicsConfig());
+        dEngine2DSwapPhysWorld(physWorld);
         return true;
     }
     return false;
 }
 
 void dPhysics2DDestroy() {
-    physWorld = nullptr;
     for (auto& ptr : rigidbodies) {
       ptr.free();
     }
@@ -52,33 +363,121 @@ void dPhysics2DDestroy() {
       ptr.free();
     }
     rigidbodies.clear();
+    rigidbodyTypes.clear();
     aabbs.clear();
     circles.clear();
     polys.clear();
+    polyRigidbodies.clear();
+
+    for (auto& records : colliderRecords) {
+        for (auto collider : records) {
+            delete collider;
+        }
+        records.clear();
+    }
+
+    if (physWorld) {
+        dEngine2DSwapPhysWorld(physWorld->wrapped());
+        delete physWorld;
+    }
+    physWorld = nullptr;
 }
 
 tCD_Handle dPhysics2DMakeRigidbody(tCD_Handle transform) {
-    return rigidbodies.insert(physWorld->makeRigidbody(dTransform2GetTransformPtr(transform)));
+    dRigidbodyDef2D def = {CD_BODY_DYNAMIC};
+    return dPhysics2DMakeRigidbodyFromDef(transform, &def);
+}
+
+tCD_Handle dPhysics2DMakeRigidbodyFromDef(tCD_Handle transform, const dRigidbodyDef2D* def) {
+    CDRigidbodyDef2D bodyDef;
+    bodyDef.type = def->type;
+
+    auto transformPtr = dTransform2GetTransformPtr(transform);
+    tCD_Handle rigidbody = rigidbodies.insert(physWorld->makeRigidbody(*transformPtr, bodyDef));
+
+    if (rigidbodyTypes.size() <= (size_t)rigidbody) rigidbodyTypes.resize(rigidbody + 1);
+    rigidbodyTypes[rigidbody] = def->type;
+
+    // static bodies don't move, so there's nothing to sync or interpolate
+    if (def->type != CD_BODY_STATIC)
+        physWorld->trackBody(rigidbody, transformPtr.get());
+    return rigidbody;
 }
 
 void dPhysics2DDestroyRigidbody(tCD_Handle rigidbody) {
+    if (rigidbodyTypes[rigidbody] != CD_BODY_STATIC)
+        physWorld->untrackBody(rigidbody);
     rigidbodies[rigidbody].free();
     rigidbodies.erase(rigidbody);
 }
 
+int dPhysics2DGetRigidbodyType(tCD_Handle rigidbody) {
+    return rigidbodyTypes[rigidbody];
+}
+
+void dPhysics2DRefreshStaticBody(tCD_Handle rigidbody) {
+    physWorld->refreshStaticBody(rigidbodies[rigidbody]);
+    ++physWorld->version;
+}
+
+void dPhysics2DGetVelocities(const tCD_Handle* bodies, int count,
+                             tD_pos* velocities) {
+    for (int i = 0; i < count; ++i) {
+        auto velocity = rigidbodies[bodies[i]]->getVelocity();
+        velocities[2 * i] = velocity.x;
+        velocities[2 * i + 1] = velocity.y;
+    }
+}
+
+void dPhysics2DSetVelocities(const tCD_Handle* bodies, int count,
+                             const tD_pos* velocities) {
+    for (int i = 0; i < count; ++i) {
+        rigidbodies[bodies[i]]->setVelocity(
+            Vector2<tD_pos>(velocities[2 * i], velocities[2 * i + 1]));
+    }
+}
+
+void dPhysics2DGetAngularVelocities(const tCD_Handle* bodies, int count,
+                                    float* angularVelocities) {
+    for (int i = 0; i < count; ++i) {
+        angularVelocities[i] = rigidbodies[bodies[i]]->getAngularVelocity();
+    }
+}
+
+void dPhysics2DSetAngularVelocities(const tCD_Handle* bodies, int count,
+                                    const float* angularVelocities) {
+    for (int i = 0; i < count; ++i) {
+        rigidbodies[bodies[i]]->setAngularVelocity(angularVelocities[i]);
+    }
+}
+
+void dPhysics2DApplyImpulses(const tCD_Handle* bodies, int count,
+                             const tD_pos* impulses) {
+    for (int i = 0; i < count; ++i) {
+        auto& body = rigidbodies[bodies[i]];
+        body->setVelocity(body->getVelocity() +
+                          Vector2<tD_pos>(impulses[2 * i], impulses[2 * i + 1]));
+    }
+}
+
 tCD_Handle dPhysics2DMakeAABBCollider(
-    tCD_Handle rigidbody, tD_pos originX, tD_pos originY, tD_pos dimX, tD_pos dimY
+    tCD_Handle rigidbody, tD_pos originX, tD_pos originY, tD_pos dimX, tD_pos dimY,
+    const dColliderFilter2D* filter
 ) {
-    return aabbs.insert(physWorld->makeAABBCollider(
+    if (!filter) filter = &defaultFilter;
+    auto collider = makeColliderRecord(CD_COLLIDER_AABB, *filter);
+    return registerCollider(collider, aabbs.insert(physWorld->makeAABBCollider(
         rigidbodies[rigidbody],
-        nullptr, // parent
-        [](void *other){}, // empty collision callback
+        collider, // parent
+        collisionCallback(collider),
         Vector2<tD_pos>(dimX, dimY),
-        Vector2<tD_pos>(originX, originY)
-    ));
+        Vector2<tD_pos>(originX, originY),
+        filter->layer
+    )));
 }
 
 void dPhysics2DDestroyAABBCollider(tCD_Handle aabb) {
+    destroyColliderRecord(CD_COLLIDER_AABB, aabb);
     aabbs[aabb].free();
     aabbs.erase(aabb);
 }
@@ -88,21 +487,27 @@ void dPhysics2DSetAABBCollider(
 ) {
     aabbs[aabb]->setOrigin(Vector2<tD_pos>(originX, originY));
     aabbs[aabb]->setDims(Vector2<tD_pos>(dimX, dimY));
+    ++physWorld->version;
 }
 
 tCD_Handle dPhysics2DMakeCircleCollider(
-    tCD_Handle rigidbody, tD_pos centerX, tD_pos centerY, tD_pos radius
+    tCD_Handle rigidbody, tD_pos centerX, tD_pos centerY, tD_pos radius,
+    const dColliderFilter2D* filter
 ) {
-    return circles.insert(physWorld->makeCircleCollider(
+    if (!filter) filter = &defaultFilter;
+    auto collider = makeColliderRecord(CD_COLLIDER_CIRCLE, *filter);
+    return registerCollider(collider, circles.insert(physWorld->makeCircleCollider(
         rigidbodies[rigidbody],
-        nullptr,
-        [](void *other){},
+        collider,
+        collisionCallback(collider),
         radius,
-        Vector2<tD_pos>(centerX, centerY)
-    ));
+        Vector2<tD_pos>(centerX, centerY),
+        filter->layer
+    )));
 }
 
 void dPhysics2DDestroyCircleCollider(tCD_Handle circle) {
+    destroyColliderRecord(CD_COLLIDER_CIRCLE, circle);
     circles[circle].free();
     circles.erase(circle);
 }
@@ -112,25 +517,109 @@ void dPhysics2DSetCircleCollider(
 ) {
     circles[circle]->setRadius(radius);
     circles[circle]->setCenter(Vector2<tD_pos>(centerX, centerY));
+    ++physWorld->version;
 }
 
 // construct points using functions in CD_Util
 tCD_Handle dPhysics2DMakePolyCollider(
-    tCD_Handle rigidbody, tCD_Handle points
+    tCD_Handle rigidbody, tCD_Handle points, const dColliderFilter2D* filter
 ) {
-    return polys.insert(physWorld->makePolyCollider(
+    auto& pointList = dGetPointList(points);
+    if (pointList.size() < 3) {
+        Log::log("A polygon collider needs at least 3 points!");
+        return CD_INVALID_HANDLE;
+    }
+
+    if (!filter) filter = &defaultFilter;
+    auto collider = makeColliderRecord(CD_COLLIDER_POLY, *filter);
+    tCD_Handle poly = registerCollider(collider, polys.insert(physWorld->makePolyCollider(
         rigidbodies[rigidbody],
-        nullptr,
-        [](void *other){},
-        dGetPointList(points)
-    ));
+        collider,
+        collisionCallback(collider),
+        pointList,
+        filter->layer
+    )));
+    if (polyRigidbodies.size() <= (size_t)poly) polyRigidbodies.resize(poly + 1);
+    polyRigidbodies[poly] = rigidbody;
+    return poly;
 }
 
 void dPhysics2DDestroyPolyCollider(tCD_Handle poly) {
+    destroyColliderRecord(CD_COLLIDER_POLY, poly);
     polys[poly].free();
     polys.erase(poly);
 }
 
+void dPhysics2DSetPolyColliderPoints(tCD_Handle poly, const tD_pos* xy, int count) {
+    if (count < 3) return;
+
+    if (physWorld->native()) {
+        static_cast<CDNativePolyCollider*>(polys[poly].get())->setPoints(xy, count);
+    }
+    else {
+        // Quantum2D's polygons can't be reshaped,
+        // so swap in a new one under the same handle and record
+        static PointList2D points;
+        points.resize(count);
+        for (int i = 0; i < count; ++i) {
+            points[i] = Vector2<tD_pos>(xy[2 * i], xy[2 * i + 1]);
+        }
+
+        auto collider = colliderRecords[CD_COLLIDER_POLY][poly];
+        CollisionLayer layer = polys[poly]->getLayer();
+        polys[poly].free();
+        polys[poly] = physWorld->makePolyCollider(
+            rigidbodies[polyRigidbodies[poly]],
+            collider,
+            collisionCallback(collider),
+            points,
+            layer
+        );
+    }
+    ++physWorld->version;
+}
+
+int dPhysics2DGetPolyColliderWorldPoints(tCD_Handle poly, tD_pos* xy, int maxPoints) {
+    static PointList2D points;
+    dPhysics2DGetPolyWorldPoints(poly, points);
+    int numPoints = std::min<int>(maxPoints, points.size());
+    for (int i = 0; i < numPoints; ++i) {
+        xy[2 * i] = points[i].x;
+        xy[2 * i + 1] = points[i].y;
+    }
+    return points.size();
+}
+
+void dPhysics2DSetColliderLayer(int type, tCD_Handle collider, int layer) {
+    dPhysics2DGetCollider(type, collider)->setLayer(layer);
+    ++physWorld->version;
+}
+
+void dPhysics2DSetColliderFilter(int type, tCD_Handle collider,
+                                 const dColliderFilter2D* filter) {
+    auto record = colliderRecords[type][collider];
+    record->category = filter->category;
+    record->mask = filter->mask;
+    if (physWorld->native())
+        physWorld->native()->setFilter(nativeShape(type, collider), filter->layer,
+                                       filter->category, filter->mask);
+    else
+        dPhysics2DGetCollider(type, collider)->setLayer(filter->layer);
+    ++physWorld->version;
+}
+
+void dPhysics2DSetLayersCollide(int layer1, int layer2, bool collides) {
+    physWorld->setLayersCollide(layer1, layer2, collides);
+    ++physWorld->version;
+}
+
+int dPhysics2DGetCollisionEvents(dCollisionEvent2D* events, int maxEvents) {
+    auto& collisionEvents = physWorld->events();
+    int numEvents = std::min<int>(maxEvents, collisionEvents.size());
+    std::copy(collisionEvents.begin(), collisionEvents.begin() + numEvents, events);
+    return collisionEvents.size();
+}
+
 DumbPtr<Rigidbody2D> &dPhysics2DGetRigidbody(tCD_Handle rigidbody) {
     return rigidbodies[rigidbody];
 }
@@ -146,3 +635,31 @@ DumbPtr<CircleCollider> &dPhysics2DGetCircleCollider(tCD_Handle circle) {
 DumbPtr<PolyCollider> &dPhysics2DGetPolyCollider(tCD_Handle poly) {
     return polys[poly];
 }
+
+void dPhysics2DGetPolyWorldPoints(tCD_Handle poly, PointList2D& out) {
+    if (physWorld->native())
+        static_cast<CDNativePolyCollider*>(polys[poly].get())->worldPoints(out);
+    else
+        out = polys[poly]->worldPoints();
+}
+
+const std::vector<CDCollider2D*> &dPhysics2DGetColliderRecords(int type) {
+    return colliderRecords[type];
+}
+
+Collider2D *dPhysics2DGetCollider(int type, tCD_Handle collider) {
+    switch (type) {
+        case CD_COLLIDER_AABB:   return aabbs[collider].get();
+        case CD_COLLIDER_CIRCLE: return circles[collider].get();
+        case CD_COLLIDER_POLY:   return polys[collider].get();
+        default:                 return nullptr;
+    }
+}
+
+uint32_t dPhysics2DGetVersion() {
+    return physWorld ? physWorld->version : 0;
+}
+
+CDNativeWorld2D* dPhysics2DGetNativeWorld() {
+    return physWorld ? physWorld->native() : nullptr;
+}
@@ -0,0 +1,708 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "CD_PhysicsQuery2D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "CD_AABBTree2D.h"
+#include "CD_Engine2D.h"
+#include "CD_NativeWorld2D.h"
+#include "CD_Physics2D.h"
+using namespace Diamond;
+
+namespace {
+    struct CDCircleShape2D {
+        float x, y, radius;
+    };
+
+    // a convex polygon's edges in a CDPolyEdges2D, from its first point to its last
+    struct CDPolyShape2D {
+        uint32_t start, count;
+    };
+
+    // convex polygons' edges, starting at each point, with outward unit
+    // normals and each edge's distance along its normal
+    struct CDPolyEdges2D {
+        std::vector<float> pointX, pointY;
+        std::vector<float> normalX, normalY, normalDist;
+
+        void clear() {
+            for (auto v : {&pointX, &pointY, &normalX, &normalY, &normalDist}) {
+                v->clear();
+            }
+        }
+
+        /**
+         * Adds the edges of the polygon with the given points and sets
+         * bounds to fit them. Polygons of less than 3 points have no
+         * edges, and a count of 0.
+         */
+        CDPolyShape2D add(const PointList2D &points, CDAABB2D &bounds) {
+            CDPolyShape2D poly{(uint32_t)pointX.size(), 0};
+            if (points.size() < 3) return poly;
+            poly.count = points.size();
+
+            // winding decides which side of each edge is out
+            float area = 0;
+            for (size_t i = 0; i < points.size(); ++i) {
+                auto &a = points[i];
+                auto &b = points[(i + 1) % points.size()];
+                area += a.x * b.y - b.x * a.y;
+            }
+            float outward = area < 0 ? -1.0f : 1.0f;
+
+            bounds = {(float)points[0].x, (float)points[0].y,
+                      (float)points[0].x, (float)points[0].y};
+            for (size_t i = 0; i < points.size(); ++i) {
+                auto &a = points[i];
+                auto &b = points[(i + 1) % points.size()];
+
+                float nx = (b.y - a.y) * outward;
+                float ny = (a.x - b.x) * outward;
+                float length = std::sqrt(nx * nx + ny * ny);
+                if (length > 0) {
+                    nx /= length;
+                    ny /= length;
+                }
+
+                pointX.push_back(a.x);
+                pointY.push_back(a.y);
+                normalX.push_back(nx);
+                normalY.push_back(ny);
+                normalDist.push_back(nx * a.x + ny * a.y);
+
+                bounds.minX = std::min<float>(bounds.minX, a.x);
+                bounds.minY = std::min<float>(bounds.minY, a.y);
+                bounds.maxX = std::max<float>(bounds.maxX, a.x);
+                bounds.maxY = std::max<float>(bounds.maxY, a.y);
+            }
+            return poly;
+        }
+    };
+
+    // A collider as the queries test it, with its shape in world space.
+    struct CDQueryShape2D {
+        int type;
+        tCD_Handle handle;
+        CDAABB2D bounds;
+        CDCircleShape2D circle;      // for circles
+        CDPolyShape2D poly;          // for polys, in edges
+        const CDPolyEdges2D *edges;
+    };
+
+    /**
+     * The colliders of the native physics world, queried through
+     * the world's own broadphase tree, which it keeps up to date.
+     */
+    class CDNativeColliders2D {
+    public:
+        void reset(const CDNativeWorld2D *nativeWorld) { world = nativeWorld; }
+
+        /**
+         * Calls fn(shape) for each collider on a layer that collides with
+         * the given layer, in a category in mask, whose fat AABB overlaps box.
+         */
+        template <typename F>
+        void query(const CDAABB2D &box, int layer, uint32_t mask, F fn) {
+            world->getTree().query(box, [&](int proxy) {
+                if (view(proxy, layer, mask)) fn(shape);
+                return true;
+            });
+        }
+
+        /**
+         * Calls fn(shape, maxFraction) like query, for colliders whose fat AABB
+         * the ray enters before maxFraction. fn returns the new maxFraction.
+         */
+        template <typename F>
+        void raycast(float ox, float oy, float dx, float dy,
+                     int layer, uint32_t mask, F fn) {
+            world->getTree().raycast(ox, oy, dx, dy, 1, [&](int proxy, float best) {
+                return view(proxy, layer, mask) ? fn(shape, best) : best;
+            });
+        }
+
+    private:
+        const CDNativeWorld2D *world = nullptr;
+
+        // the collider being visited, and its poly edges if it's a poly
+        CDQueryShape2D shape;
+        CDPolyEdges2D edges;
+
+        bool view(int proxy, int layer, uint32_t mask) {
+            auto &collider = *static_cast<const CDNativeShape2D*>(
+                world->getTree().getUserData(proxy));
+            if (!world->doLayersCollide((CollisionLayer)layer, collider.layer) ||
+                !(collider.category & mask)) {
+                return false;
+            }
+
+            shape.type = collider.type;
+            // colliders are made with their records as their parents
+            shape.handle = static_cast<const CDCollider2D*>(collider.parent)->handle;
+            shape.bounds = collider.bounds;
+            if (collider.type == CD_COLLIDER_CIRCLE) {
+                shape.circle = {(float)collider.worldCenter.x, (float)collider.worldCenter.y,
+                                (float)collider.worldRadius};
+            }
+            else if (collider.type == CD_COLLIDER_POLY) {
+                CDAABB2D bounds;
+                edges.clear();
+                shape.poly = edges.add(collider.worldPoints, bounds);
+                shape.edges = &edges;
+                if (shape.poly.count == 0) return false;
+            }
+            return true;
+        }
+    };
+
+    /**
+     * The colliders of the engine's Quantum2D world, which has no tree of
+     * its own to query, copied out with their world shapes and kept in a
+     * bounding volume tree.
+     * Brought up to date by the first query after the physics world has
+     * changed, so any number of queries between changes share one update.
+     * Each proxy is refit in place, so colliders that stay within their
+     * fat AABBs leave the tree as it is.
+     */
+    class CDColliderSnapshot2D {
+    public:
+        void update() {
+            uint32_t version = dPhysics2DGetVersion();
+            if (built && version == builtVersion) return;
+            built = true;
+            builtVersion = version;
+
+            edges.clear();
+            presentLayers.clear();
+            bool present[256] = {};
+
+            for (int type = 0; type < CD_NUM_COLLIDER_TYPES; ++type) {
+                auto &records = dPhysics2DGetColliderRecords(type);
+                auto &typeEntries = entries[type];
+                if (typeEntries.size() < records.size())
+                    typeEntries.resize(records.size());
+
+                for (size_t handle = 0; handle < typeEntries.size(); ++handle) {
+                    auto record = handle < records.size() ? records[handle] : nullptr;
+                    auto &entry = typeEntries[handle];
+                    CDAABB2D old = entry.shape.bounds;
+
+                    // destroyed, or its handle went to another collider
+                    if (entry.proxy != CDAABBTree2D::NULL_NODE &&
+                        (!record || record->id != entry.id || !read(record, entry))) {
+                        tree.remove(entry.proxy);
+                        entry.proxy = CDAABBTree2D::NULL_NODE;
+                    }
+                    else if (entry.proxy != CDAABBTree2D::NULL_NODE) {
+                        tree.move(entry.proxy, entry.shape.bounds,
+                                  entry.shape.bounds.minX - old.minX,
+                                  entry.shape.bounds.minY - old.minY);
+                    }
+
+                    if (entry.proxy == CDAABBTree2D::NULL_NODE) {
+                        if (!record || !read(record, entry)) continue;
+                        entry.id = record->id;
+                        entry.proxy = tree.insert(entry.shape.bounds,
+                            (void*)(uintptr_t)(handle * CD_NUM_COLLIDER_TYPES + type));
+                    }
+
+                    if (!present[entry.layer]) {
+                        present[entry.layer] = true;
+                        presentLayers.push_back(entry.layer);
+                    }
+                }
+            }
+            std::fill(filterBuilt, filterBuilt + 256, false);
+        }
+
+        // see CDNativeColliders2D::query
+        template <typename F>
+        void query(const CDAABB2D &box, int layer, uint32_t mask, F fn) {
+            const bool *filter = layerFilter(layer);
+            tree.query(box, [&](int proxy) {
+                auto &entry = entryOf(proxy);
+                if (filter[entry.layer] && (entry.category & mask)) fn(entry.shape);
+                return true;
+            });
+        }
+
+        // see CDNativeColliders2D::raycast
+        template <typename F>
+        void raycast(float ox, float oy, float dx, float dy,
+                     int layer, uint32_t mask, F fn) {
+            const bool *filter = layerFilter(layer);
+            tree.raycast(ox, oy, dx, dy, 1, [&](int proxy, float best) {
+                auto &entry = entryOf(proxy);
+                if (!filter[entry.layer] || !(entry.category & mask)) return best;
+                return fn(entry.shape, best);
+            });
+        }
+
+    private:
+        struct Entry {
+            // of the collider's record, since handles are reused
+            uint32_t id = 0;
+            int proxy = CDAABBTree2D::NULL_NODE;
+            CollisionLayer layer = 0;
+            uint32_t category = 0;
+            CDQueryShape2D shape = {};
+        };
+
+        // by collider type, then by handle
+        std::vector<Entry> entries[CD_NUM_COLLIDER_TYPES];
+        // with each proxy's handle * CD_NUM_COLLIDER_TYPES + type as its user data
+        CDAABBTree2D tree;
+        // every poly's edges, refilled on every update
+        CDPolyEdges2D edges;
+
+        bool built = false;
+        uint32_t builtVersion = 0;
+
+        std::vector<CollisionLayer> presentLayers;
+        bool layerFilters[256][256];
+        bool filterBuilt[256];
+
+        // reused between updates
+        PointList2D points;
+
+        Entry &entryOf(int proxy) {
+            auto key = (uintptr_t)tree.getUserData(proxy);
+            return entries[key % CD_NUM_COLLIDER_TYPES][key / CD_NUM_COLLIDER_TYPES];
+        }
+
+        // Reads the collider's current shape into entry,
+        // or returns false if it has none to test (a poly of less than 3 points).
+        bool read(const CDCollider2D *record, Entry &entry) {
+            auto &shape = entry.shape;
+            shape.type = record->type;
+            shape.handle = record->handle;
+            entry.category = record->category;
+
+            switch (record->type) {
+                case CD_COLLIDER_AABB: {
+                    auto &collider = dPhysics2DGetAABBCollider(record->handle);
+                    auto min = collider->getMin();
+                    auto max = collider->getMax();
+                    entry.layer = collider->getLayer();
+                    shape.bounds = {(float)min.x, (float)min.y, (float)max.x, (float)max.y};
+                    return true;
+                }
+                case CD_COLLIDER_CIRCLE: {
+                    auto &collider = dPhysics2DGetCircleCollider(record->handle);
+                    auto center = collider->getWorldPos();
+                    float radius = collider->getWorldRadius();
+                    entry.layer = collider->getLayer();
+                    shape.circle = {(float)center.x, (float)center.y, radius};
+                    shape.bounds = {shape.circle.x - radius, shape.circle.y - radius,
+                                    shape.circle.x + radius, shape.circle.y + radius};
+                    return true;
+                }
+                default: {
+                    dPhysics2DGetPolyWorldPoints(record->handle, points);
+                    entry.layer = dPhysics2DGetPolyCollider(record->handle)->getLayer();
+                    shape.poly = edges.add(points, shape.bounds);
+                    shape.edges = &edges;
+                    return shape.poly.count > 0;
+                }
+            }
+        }
+
+        /**
+         * Which layers collide with the given query layer, by layer.
+         * Only valid for the layers that colliders are on.
+         */
+        const bool *layerFilter(int queryLayer) {
+            auto layer = (CollisionLayer)queryLayer;
+            bool *filter = layerFilters[layer];
+            if (!filterBuilt[layer]) {
+                auto world = dEngine2DGetEngine()->getPhysWorld();
+                for (auto colliderLayer : presentLayers) {
+                    filter[colliderLayer] = world->doLayersCollide(layer, colliderLayer);
+                }
+                filterBuilt[layer] = true;
+            }
+            return filter;
+        }
+    };
+}
+
+static CDNativeColliders2D nativeColliders;
+static CDColliderSnapshot2D snapshot;
+
+// Readies whichever colliders the queries go through, before each query or batch.
+static void prepareColliders() {
+    auto native = dPhysics2DGetNativeWorld();
+    nativeColliders.reset(native);
+    if (!native) snapshot.update();
+}
+
+// The colliders on layers that collide with layer and in categories in mask,
+// see CDNativeColliders2D::query and raycast.
+template <typename F>
+static void queryColliders(const CDAABB2D &box, int layer, uint32_t mask, F fn) {
+    if (dPhysics2DGetNativeWorld()) nativeColliders.query(box, layer, mask, fn);
+    else                            snapshot.query(box, layer, mask, fn);
+}
+
+template <typename F>
+static void raycastColliders(float ox, float oy, float dx, float dy,
+                             int layer, uint32_t mask, F fn) {
+    if (dPhysics2DGetNativeWorld()) nativeColliders.raycast(ox, oy, dx, dy, layer, mask, fn);
+    else                            snapshot.raycast(ox, oy, dx, dy, layer, mask, fn);
+}
+
+
+// Raycasts. Each returns whether the ray from (ox, oy) along (dx, dy)
+// hits the shape before fraction t, and if so lowers t to the hit
+// and sets the normal at the hit.
+
+static bool raycastBox(float ox, float oy, float dx, float dy,
+                       float minX, float minY, float maxX, float maxY,
+                       float &t, float &nx, float &ny) {
+    float enter = 0, exit = t;
+    float enterNX = 0, enterNY = 0;
+
+    if (dx == 0) {
+        if (ox < minX || ox > maxX) return false;
+    }
+    else {
+        float t0 = (minX - ox) / dx, t1 = (maxX - ox) / dx;
+        float n = -1;
+        if (t0 > t1) { std::swap(t0, t1); n = 1; }
+        if (t0 > enter) { enter = t0; enterNX = n; enterNY = 0; }
+        exit = std::min(exit, t1);
+        if (enter > exit) return false;
+    }
+
+    if (dy == 0) {
+        if (oy < minY || oy > maxY) return false;
+    }
+    else {
+        float t0 = (minY - oy) / dy, t1 = (maxY - oy) / dy;
+        float n = -1;
+        if (t0 > t1) { std::swap(t0, t1); n = 1; }
+        if (t0 > enter) { enter = t0; enterNX = 0; enterNY = n; }
+        exit = std::min(exit, t1);
+        if (enter > exit) return false;
+    }
+
+    t = enter;
+    nx = enterNX;
+    ny = enterNY;
+    return true;
+}
+
+static bool raycastCircle(float ox, float oy, float dx, float dy,
+                          const CDCircleShape2D &circle,
+                          float &t, float &nx, float &ny) {
+    float mx = ox - circle.x, my = oy - circle.y;
+    float c = mx * mx + my * my - circle.radius * circle.radius;
+    if (c <= 0) {
+        t = 0;
+        nx = ny = 0;
+        return true;
+    }
+
+    float a = dx * dx + dy * dy;
+    float b = mx * dx + my * dy;
+    float discriminant = b * b - a * c;
+    if (a == 0 || b >= 0 || discriminant < 0) return false;
+
+    float hit = (-b - std::sqrt(discriminant)) / a;
+    if (hit > t) return false;
+
+    t = hit;
+    nx = (mx + hit * dx) / circle.radius;
+    ny = (my + hit * dy) / circle.radius;
+    return true;
+}
+
+static bool raycastPoly(float ox, float oy, float dx, float dy,
+                        const CDPolyEdges2D &edges, const CDPolyShape2D &poly,
+                        float &t, float &nx, float &ny) {
+    float enter = 0, exit = t;
+    float enterNX = 0, enterNY = 0;
+
+    for (uint32_t i = poly.start; i < poly.start + poly.count; ++i) {
+        float n_x = edges.normalX[i], n_y = edges.normalY[i];
+        float dist = edges.normalDist[i] - (n_x * ox + n_y * oy);
+        float along = n_x * dx + n_y * dy;
+
+        if (along == 0) {
+            if (dist < 0) return false;
+        }
+        else if (along < 0) {
+            float edgeT = dist / along;
+            if (edgeT > enter) { enter = edgeT; enterNX = n_x; enterNY = n_y; }
+        }
+        else {
+            exit = std::min(exit, dist / along);
+        }
+        if (enter > exit) return false;
+    }
+
+    t = enter;
+    nx = enterNX;
+    ny = enterNY;
+    return true;
+}
+
+static bool raycast(const dRay2D &ray, dRaycastHit2D &hit) {
+    float ox = ray.startX, oy = ray.startY;
+    float dx = ray.endX - ray.startX, dy = ray.endY - ray.startY;
+
+    hit.type = -1;
+    hit.collider = CD_INVALID_HANDLE;
+
+    raycastColliders(ox, oy, dx, dy, ray.layer, ray.mask,
+                     [&](const CDQueryShape2D &shape, float best) {
+        auto &bounds = shape.bounds;
+        float t = best, nx, ny;
+        if (!raycastBox(ox, oy, dx, dy,
+                        bounds.minX, bounds.minY, bounds.maxX, bounds.maxY, t, nx, ny)) {
+            return best;
+        }
+
+        // a hit on the bounds is a hit on an AABB, and the earliest
+        // that any other shape could be hit
+        if (shape.type != CD_COLLIDER_AABB) {
+            t = best;
+            bool hitShape = shape.type == CD_COLLIDER_CIRCLE
+                ? raycastCircle(ox, oy, dx, dy, shape.circle, t, nx, ny)
+                : raycastPoly(ox, oy, dx, dy, *shape.edges, shape.poly, t, nx, ny);
+            if (!hitShape) return best;
+        }
+
+        // ties go to whichever was found first
+        if (hit.type != -1 && t >= best) return best;
+
+        hit.type = shape.type;
+        hit.collider = shape.handle;
+        hit.fraction = t;
+        hit.x = ox + t * dx;
+        hit.y = oy + t * dy;
+        hit.normalX = nx;
+        hit.normalY = ny;
+        return t;
+    });
+
+    return hit.type != -1;
+}
+
+
+// Overlap tests against a collider's shape,
+// for colliders whose bounds already overlap the query's bounds.
+
+static bool boxOverlaps(const CDQueryShape2D &shape, const dAABBQuery2D &box) {
+    switch (shape.type) {
+        case CD_COLLIDER_CIRCLE: {
+            auto &circle = shape.circle;
+            float x = std::max(box.minX, std::min(circle.x, box.maxX)) - circle.x;
+            float y = std::max(box.minY, std::min(circle.y, box.maxY)) - circle.y;
+            return x * x + y * y <= circle.radius * circle.radius;
+        }
+        case CD_COLLIDER_POLY: {
+            // the bounds checked the box's axes, so separating
+            // along an edge normal is all that's left
+            auto &edges = *shape.edges;
+            auto &poly = shape.poly;
+            float cx = (box.minX + box.maxX) * 0.5f, cy = (box.minY + box.maxY) * 0.5f;
+            float hx = (box.maxX - box.minX) * 0.5f, hy = (box.maxY - box.minY) * 0.5f;
+            for (uint32_t e = poly.start; e < poly.start + poly.count; ++e) {
+                float n_x = edges.normalX[e], n_y = edges.normalY[e];
+                float nearest = n_x * cx + n_y * cy - (std::abs(n_x) * hx + std::abs(n_y) * hy);
+                if (nearest > edges.normalDist[e]) return false;
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+static bool pointInPoly(const CDPolyEdges2D &edges, const CDPolyShape2D &poly,
+                        float x, float y) {
+    for (uint32_t e = poly.start; e < poly.start + poly.count; ++e) {
+        if (edges.normalX[e] * x + edges.normalY[e] * y > edges.normalDist[e])
+            return false;
+    }
+    return true;
+}
+
+static bool circleOverlaps(const CDQueryShape2D &shape, const dCircleQuery2D &query) {
+    float radiusSq = query.radius * query.radius;
+    switch (shape.type) {
+        case CD_COLLIDER_AABB: {
+            auto &bounds = shape.bounds;
+            float x = std::max(bounds.minX, std::min(query.x, bounds.maxX)) - query.x;
+            float y = std::max(bounds.minY, std::min(query.y, bounds.maxY)) - query.y;
+            return x * x + y * y <= radiusSq;
+        }
+        case CD_COLLIDER_CIRCLE: {
+            auto &circle = shape.circle;
+            float x = circle.x - query.x, y = circle.y - query.y;
+            float reach = circle.radius + query.radius;
+            return x * x + y * y <= reach * reach;
+        }
+        case CD_COLLIDER_POLY: {
+            auto &edges = *shape.edges;
+            auto &poly = shape.poly;
+            if (pointInPoly(edges, poly, query.x, query.y)) return true;
+
+            // otherwise it overlaps if any edge is within its radius
+            uint32_t end = poly.start + poly.count;
+            for (uint32_t e = poly.start; e < end; ++e) {
+                uint32_t next = e + 1 < end ? e + 1 : poly.start;
+                float ax = edges.pointX[e], ay = edges.pointY[e];
+                float ex = edges.pointX[next] - ax, ey = edges.pointY[next] - ay;
+                float lengthSq = ex * ex + ey * ey;
+                float t = lengthSq > 0
+                    ? std::max(0.0f, std::min(1.0f, ((query.x - ax) * ex + (query.y - ay) * ey) / lengthSq))
+                    : 0;
+                float x = ax + t * ex - query.x, y = ay + t * ey - query.y;
+                if (x * x + y * y <= radiusSq) return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+static bool pointOverlaps(const CDQueryShape2D &shape, const dPointQuery2D &query) {
+    switch (shape.type) {
+        case CD_COLLIDER_CIRCLE: {
+            auto &circle = shape.circle;
+            float x = circle.x - query.x, y = circle.y - query.y;
+            return x * x + y * y <= circle.radius * circle.radius;
+        }
+        case CD_COLLIDER_POLY:
+            return pointInPoly(*shape.edges, shape.poly, query.x, query.y);
+        default:
+            return true;
+    }
+}
+
+/**
+ * Finds the colliders on layers that collide with the query's and in
+ * categories in its mask whose bounds overlap the given bounds,
+ * then checks their shapes with overlaps.
+ * Writes up to maxResults of them into results and returns how many were found.
+ */
+template <typename Query, typename Overlaps>
+static int queryOverlaps(const Query &query,
+                         float minX, float minY, float maxX, float maxY,
+                         Overlaps overlaps,
+                         dColliderRef2D *results, int maxResults) {
+    const CDAABB2D box = {minX, minY, maxX, maxY};
+    int found = 0;
+
+    // the tree only knows fat bounds
+    queryColliders(box, query.layer, query.mask, [&](const CDQueryShape2D &shape) {
+        if (!shape.bounds.overlaps(box) || !overlaps(shape, query)) return;
+
+        if (found < maxResults) {
+            results[found] = {shape.type, shape.handle};
+        }
+        ++found;
+    });
+
+    return found;
+}
+
+static int queryAABB(const dAABBQuery2D &query, dColliderRef2D *results, int maxResults) {
+    return queryOverlaps(query, query.minX, query.minY, query.maxX, query.maxY,
+                         boxOverlaps, results, maxResults);
+}
+
+static int queryCircle(const dCircleQuery2D &query, dColliderRef2D *results, int maxResults) {
+    return queryOverlaps(query,
+                         query.x - query.radius, query.y - query.radius,
+                         query.x + query.radius, query.y + query.radius,
+                         circleOverlaps, results, maxResults);
+}
+
+static int queryPoint(const dPointQuery2D &query, dColliderRef2D *results, int maxResults) {
+    return queryOverlaps(query, query.x, query.y, query.x, query.y,
+                         pointOverlaps, results, maxResults);
+}
+
+template <typename Query, typename Run>
+static int queryBatch(const Query *queries, int numQueries,
+                      dColliderRef2D *results, int maxResults, int *counts,
+                      Run run) {
+    prepareColliders();
+    int written = 0;
+    for (int i = 0; i < numQueries; ++i) {
+        int space = maxResults - written;
+        counts[i] = std::min(space, run(queries[i], results + written, space));
+        written += counts[i];
+    }
+    return written;
+}
+
+
+bool dPhysics2DRaycast(const dRay2D* ray, dRaycastHit2D* hit) {
+    prepareColliders();
+    return raycast(*ray, *hit);
+}
+
+int dPhysics2DRaycastBatch(const dRay2D* rays, int numRays, dRaycastHit2D* hits) {
+    prepareColliders();
+    int numHits = 0;
+    for (int i = 0; i < numRays; ++i) {
+        if (raycast(rays[i], hits[i])) ++numHits;
+    }
+    return numHits;
+}
+
+int dPhysics2DQueryAABB(const dAABBQuery2D* query,
+                        dColliderRef2D* results, int maxResults) {
+    prepareColliders();
+    return queryAABB(*query, results, maxResults);
+}
+
+int dPhysics2DQueryCircle(const dCircleQuery2D* query,
+                          dColliderRef2D* results, int maxResults) {
+    prepareColliders();
+    return queryCircle(*query, results, maxResults);
+}
+
+int dPhysics2DQueryPoint(const dPointQuery2D* query,
+                         dColliderRef2D* results, int maxResults) {
+    prepareColliders();
+    return queryPoint(*query, results, maxResults);
+}
+
+int dPhysics2DQueryAABBBatch(const dAABBQuery2D* queries, int numQueries,
+                             dColliderRef2D* results, int maxResults, int* counts) {
+    return queryBatch(queries, numQueries, results, maxResults, counts, queryAABB);
+}
+
+int dPhysics2DQueryCircleBatch(const dCircleQuery2D* queries, int numQueries,
+                               dColliderRef2D* results, int maxResults, int* counts) {
+    return queryBatch(queries, numQueries, results, maxResults, counts, queryCircle);
+}
+
+int dPhysics2DQueryPointBatch(const dPointQuery2D* queries, int numQueries,
+                              dColliderRef2D* results, int maxResults, int* counts) {
+    return queryBatch(queries, numQueries, results, maxResults, counts, queryPoint);
+}
@@ -16,34 +16,320 @@
 
 #include "CD_Renderer2D.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SDL.h"
+#include "SDL_image.h"
 #include "duSwapVector.h"
+#include "D_Log.h"
+#include "D_SDLTexture.h"
 #include "CD_Engine2D.h"
+#include "CD_TextureCache.h"
+#include "CD_ThreadPool.h"
 #include "CD_Transform2.h"
 using namespace Diamond;
 
-static Renderer2D* renderer = nullptr;
+/**
+ * Wraps the engine's renderer to count what each frame costs.
+ * Render components made through it are tracked until they are freed,
+ * using a deleter that forwards to the wrapped renderer's deleter.
+ */
+class CDRenderer2D : public Renderer2D {
+public:
+    CDRenderer2D(Renderer2D* renderer)
+        : renderer(renderer),
+          deleter(*this),
+          numPoints(0),
+          numLines(0) {
+        std::memset(&frameStats, 0, sizeof(frameStats));
+    }
+
+    Renderer2D* wrapped() const { return renderer; }
+
+    const dRenderStats2D& stats() const { return frameStats; }
+
+    void renderAll() override {
+        countFrame();
+
+        auto start = std::chrono::steady_clock::now();
+        renderer->renderAll();
+        std::chrono::duration<float, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        frameStats.renderTimeMs = elapsed.count();
+    }
+
+    Vector2<int> getResolution() const override {
+        return renderer->getResolution();
+    }
+
+    Vector2<int> getScreenResolution() const override {
+        return renderer->getScreenResolution();
+    }
+
+    int getRefreshRate() const override {
+        return renderer->getRefreshRate();
+    }
+
+    DumbPtr<Font> loadFont(const std::string& fontPath, int ptsize) override {
+        return renderer->loadFont(fontPath, ptsize);
+    }
+
+    DumbPtr<Texture> loadTexture(std::string path) override {
+        return renderer->loadTexture(path);
+    }
+
+    DumbPtr<Texture> loadTextTexture(const std::string& text,
+                                     const Font* font,
+                                     const RGBA& color) override {
+        return renderer->loadTextTexture(text, font, color);
+    }
+
+    using Renderer2D::makeRenderComponent;
+
+    DumbPtr<RenderComponent2D> makeRenderComponent(
+        const DTransform2& transform,
+        const Texture* texture,
+        RenderLayer layer = 0,
+        const Vector2<tD_pos>& pivot = Vector2<tD_pos>(0, 0)
+    ) override {
+        auto rcomp = renderer->makeRenderComponent(transform, texture, layer, pivot);
+        if (!rcomp) return rcomp;
+
+        tracked[rcomp.get()] = {layer, 0, rcomp.get_deleter()};
+        append(rcomp.get(), layer);
+
+        return DumbPtr<RenderComponent2D>(rcomp.get(), &deleter);
+    }
+
+    void renderPoint(const Vector2<tD_pos>& coords,
+                     const RGBA& color) override {
+        ++numPoints;
+        renderer->renderPoint(coords, color);
+    }
+
+    void renderLine(const Vector2<tD_pos>& p1,
+                    const Vector2<tD_pos>& p2,
+                    const RGBA& color) override {
+        ++numLines;
+        renderer->renderLine(p1, p2, color);
+    }
+
+    // Moves rcomp to newLayer, and to the end of it as the renderer does.
+    void setLayer(RenderComponent2D* rcomp, RenderLayer newLayer) {
+        rcomp->setLayer(newLayer);
+
+        auto i = tracked.find(rcomp);
+        if (i == tracked.end()) return;
+        removeFromLayer(i->second);
+        i->second.layer = newLayer;
+        append(rcomp, newLayer);
+    }
+
+private:
+    struct TrackedComponent {
+        RenderLayer layer;
+        size_t index; // in layers[layer]
+        const DumbDeleter* deleter;
+    };
+
+    class TrackingDeleter : public DumbDeleter {
+    public:
+        TrackingDeleter(CDRenderer2D& owner) : owner(owner) {}
+
+        void free(void* ptr) const override {
+            owner.untrack((RenderComponent2D*)ptr);
+        }
+
+    private:
+        CDRenderer2D& owner;
+    };
+
+    Renderer2D* renderer;
+    TrackingDeleter deleter;
+
+    std::unordered_map<const RenderComponent2D*, TrackedComponent> tracked;
+
+    // the components of each layer, kept in the order the SDL renderer
+    // draws them in: it keeps each layer in a SwapVector, so a freed
+    // component is replaced by the last one of its layer, and a component
+    // that changes layer goes to the end of the new one.
+    std::vector<std::vector<RenderComponent2D*> > layers;
+
+    int numPoints;
+    int numLines;
+    dRenderStats2D frameStats;
+
+    void append(RenderComponent2D* rcomp, RenderLayer layer) {
+        if (layer >= layers.size())
+            layers.resize(layer + 1);
+        tracked[rcomp].index = layers[layer].size();
+        layers[layer].push_back(rcomp);
+    }
+
+    void removeFromLayer(const TrackedComponent& t) {
+        auto& layer = layers[t.layer];
+        if (t.index < layer.size() - 1) {
+            layer[t.index] = layer.back();
+            tracked[layer[t.index]].index = t.index;
+        }
+        layer.pop_back();
+    }
+
+    void untrack(RenderComponent2D* rcomp) {
+        auto i = tracked.find(rcomp);
+        if (i == tracked.end()) return;
+
+        auto rcompDeleter = i->second.deleter;
+        removeFromLayer(i->second);
+        tracked.erase(i);
+
+        if (rcompDeleter) rcompDeleter->free(rcomp);
+        else              delete rcomp;
+    }
+
+    void countFrame() {
+        auto& stats = frameStats;
+        std::memset(&stats, 0, sizeof(stats));
+
+        stats.objects = tracked.size();
+        stats.pointsQueued = numPoints;
+        stats.linesQueued = numLines;
+        numPoints = 0;
+        numLines = 0;
+
+        // render state carries over from one draw to the next,
+        // starting from an unmodulated texture.
+        const Texture* lastSprite = nullptr;
+        RGB lastColor = {255, 255, 255};
+        uint8_t lastAlpha = 255;
+
+        for (size_t layer = 0; layer < layers.size(); ++layer) {
+            if (layers[layer].empty()) continue;
+
+            if (layer < CD_RENDER_STATS_MAX_LAYERS) {
+                stats.objectsPerLayer[layer] = layers[layer].size();
+                stats.numLayers = layer + 1;
+            }
+
+            for (auto rcomp : layers[layer]) {
+                auto sprite = rcomp->getSprite();
+                auto alpha = rcomp->getAlpha();
+                if (!sprite || alpha == 0) {
+                    ++stats.culled;
+                    continue;
+                }
+
+                auto color = rcomp->getColor();
+                ++stats.drawCalls;
+
+                if (sprite != lastSprite) {
+                    ++stats.textureSwitches;
+                    lastSprite = sprite;
+                }
+                if (color.r != lastColor.r ||
+                    color.g != lastColor.g ||
+                    color.b != lastColor.b) {
+                    ++stats.colorModChanges;
+                    lastColor = color;
+                }
+                if (alpha != lastAlpha) {
+                    ++stats.alphaModChanges;
+                    lastAlpha = alpha;
+                }
+            }
+        }
+    }
+};
+
+static CDRenderer2D* renderer = nullptr;
 static TextureFactory* textureFactory = nullptr;
 static SwapVector<DumbPtr<RenderComponent2D>, tCD_Handle> renderComponents;
-static SwapVector<DumbPtr<Texture>, tCD_Handle> textures;
+static SwapVector<CDTexture2D, tCD_Handle> textures;
+
+// textures loaded from files, shared by every handle to the same path
+static CDTextureCache* textureCache = nullptr;
+static const size_t DEFAULT_TEXTURE_BUDGET = 256 * 1024 * 1024;
+
+// the sprite each render component holds a texture reference to
+static std::unordered_map<tCD_Handle, const Texture*> componentSprites;
+
+// An image decoded by a loader thread, waiting to be uploaded.
+struct CDTextureLoad {
+    tCD_Handle handle;
+    std::string path;
+    SDL_Surface* surface;
+};
+
+// made on the first asynchronous load
+static CDThreadPool* loaderPool = nullptr;
+
+// filled by the loader threads
+static std::mutex decodedLoadsMutex;
+static std::vector<CDTextureLoad> decodedLoads;
+
+// texture handles that are still loading,
+// mapped to whether they were destroyed while loading
+static std::unordered_map<tCD_Handle, bool> pendingLoads;
+
+// finished loads that haven't been polled yet
+static std::vector<std::pair<tCD_Handle, int> > finishedLoads;
+
+// CD_TEXTURE_* by texture handle. Handles that failed to load or were
+// destroyed stay CD_TEXTURE_FAILED until they are reused.
+static std::vector<uint8_t> textureStates;
+
+static void setTextureState(tCD_Handle texture, int state) {
+    if ((size_t)texture >= textureStates.size())
+        textureStates.resize(texture + 1, CD_TEXTURE_FAILED);
+    textureStates[texture] = state;
+}
 
 bool dRenderer2DInit() {
     auto engine = dEngine2DGetEngine();
-    if (engine) {
-        renderer = engine->getRenderer();
+    if (engine && engine->getRenderer()) {
+        renderer = new CDRenderer2D(engine->getRenderer());
+        dEngine2DSwapRenderer(renderer);
         textureFactory = new TextureFactory(renderer);
+        textureCache = new CDTextureCache(DEFAULT_TEXTURE_BUDGET);
     }
     return renderer != nullptr;
 }
 
 void dRenderer2DDestroy() {
-    for (auto& ptr : renderComponents) {
-      ptr.free();
+    // waits for images that are being decoded
+    delete loaderPool;
+    loaderPool = nullptr;
+    for (auto& load : decodedLoads) {
+      SDL_FreeSurface(load.surface);
     }
-    for (auto& ptr : textures) {
+    decodedLoads.clear();
+    pendingLoads.clear();
+    finishedLoads.clear();
+
+    for (auto& ptr : renderComponents) {
       ptr.free();
     }
     renderComponents.clear();
+    componentSprites.clear();
     textures.clear();
+    textureStates.clear();
+
+    // frees every texture that was loaded from a file
+    delete textureCache;
+    textureCache = nullptr;
+    delete textureFactory;
+    textureFactory = nullptr;
+
+    if (renderer) {
+        dEngine2DSwapRenderer(renderer->wrapped());
+        delete renderer;
+    }
     renderer = nullptr;
 }
 
@@ -59,32 +345,228 @@ void dRenderer2DGetScreenResolution(int* x, int* y) {
     *y = res.y;
 }
 
+void dRenderer2DGetStats(dRenderStats2D* stats) {
+    *stats = renderer->stats();
+}
+
+// Draws only the texture region that the given texture handle refers to.
+static void clipToTexture(RenderComponent2D* rcomp, const CDTexture2D& tex) {
+    rcomp->setClip(tex.x, tex.y, tex.w, tex.h);
+}
+
+// Uploads the given image and caches it under the given path
+// with one reference. Returns nullptr if it couldn't be uploaded.
+static Texture* cacheTexture(const std::string& path, SDL_Surface* surface) {
+    auto sdlRenderer = dRenderer2DGetSDLRenderer();
+    if (!sdlRenderer) return nullptr;
+
+    auto sdlTexture = SDL_CreateTextureFromSurface(sdlRenderer, surface);
+    if (!sdlTexture) return nullptr;
+    SDL_SetTextureBlendMode(sdlTexture, SDL_BLENDMODE_BLEND);
+
+    Uint32 format;
+    int w, h;
+    SDL_QueryTexture(sdlTexture, &format, nullptr, &w, &h);
+
+    auto texture = new SDLTexture(sdlTexture, w, h);
+    textureCache->insert(path, texture, (size_t)w * h * SDL_BYTESPERPIXEL(format));
+    return texture;
+}
+
+// Makes a handle that owns one reference to the given cached texture.
+static tCD_Handle insertTexture(Texture* texture) {
+    tCD_Handle handle = textures.insert({DumbPtr<Texture>(texture), false,
+                                         0, 0, texture->getWidth(), texture->getHeight()});
+    setTextureState(handle, CD_TEXTURE_LOADED);
+    return handle;
+}
+
 tCD_Handle dRenderer2DLoadTexture(char* path) {
-    auto texture = textureFactory->loadTexture(path);
-    if (!texture) return CD_INVALID_HANDLE;
-    return textures.insert(texture);
+    std::string pathstr(path);
+
+    auto texture = textureCache->acquire(pathstr);
+    if (!texture) {
+        auto surface = IMG_Load(path);
+        if (!surface) {
+            Log::log("Failed to load texture " + pathstr +
+                     "! SDL_image Error: " + std::string(IMG_GetError()));
+            return CD_INVALID_HANDLE;
+        }
+
+        texture = cacheTexture(pathstr, surface);
+        SDL_FreeSurface(surface);
+        if (!texture) {
+            Log::log("Failed to load texture " + pathstr +
+                     "! SDL Error: " + std::string(SDL_GetError()));
+            return CD_INVALID_HANDLE;
+        }
+    }
+
+    return insertTexture(texture);
+}
+
+tCD_Handle dRenderer2DLoadTextureAsync(char* path) {
+    std::string pathstr(path);
+
+    // already loaded textures finish right away
+    auto texture = textureCache->acquire(pathstr);
+    if (texture) {
+        tCD_Handle handle = insertTexture(texture);
+        finishedLoads.push_back({handle, CD_TEXTURE_LOADED});
+        return handle;
+    }
+
+    if (!loaderPool) loaderPool = new CDThreadPool();
+
+    // reserve the handle until the texture is uploaded
+    tCD_Handle handle = textures.insert({DumbPtr<Texture>(), false, 0, 0, 0, 0});
+    pendingLoads[handle] = false;
+    setTextureState(handle, CD_TEXTURE_LOADING);
+
+    loaderPool->submit([handle, pathstr] {
+        auto surface = IMG_Load(pathstr.c_str());
+        std::lock_guard<std::mutex> lock(decodedLoadsMutex);
+        decodedLoads.push_back({handle, pathstr, surface});
+    });
+
+    return handle;
+}
+
+int dRenderer2DGetTextureState(tCD_Handle texture) {
+    if (texture < 0 || (size_t)texture >= textureStates.size()) return CD_TEXTURE_FAILED;
+    return textureStates[texture];
+}
+
+void dRenderer2DUpdateTextureLoads() {
+    if (pendingLoads.empty()) return;
+
+    std::vector<CDTextureLoad> loads;
+    {
+        std::lock_guard<std::mutex> lock(decodedLoadsMutex);
+        loads.swap(decodedLoads);
+    }
+
+    for (auto& load : loads) {
+        bool destroyed = pendingLoads[load.handle];
+        pendingLoads.erase(load.handle);
+
+        Texture* texture = nullptr;
+        if (!destroyed) {
+            // another load of the same path may have finished first.
+            // this load was counted as a miss when it started.
+            texture = textureCache->acquireUncounted(load.path);
+            if (!texture && load.surface)
+                texture = cacheTexture(load.path, load.surface);
+        }
+
+        if (destroyed) {
+            textures.erase(load.handle);
+        }
+        else if (texture) {
+            textures[load.handle] = {DumbPtr<Texture>(texture), false,
+                                     0, 0, texture->getWidth(), texture->getHeight()};
+            setTextureState(load.handle, CD_TEXTURE_LOADED);
+            finishedLoads.push_back({load.handle, CD_TEXTURE_LOADED});
+        }
+        else {
+            Log::log("Failed to load texture " + load.path + "! " +
+                     (load.surface ? "SDL Error: " + std::string(SDL_GetError())
+                                   : std::string("Image could not be decoded.")));
+            textures.erase(load.handle);
+            setTextureState(load.handle, CD_TEXTURE_FAILED);
+            finishedLoads.push_back({load.handle, CD_TEXTURE_FAILED});
+        }
+
+        SDL_FreeSurface(load.surface);
+    }
+}
+
+int dRenderer2DPollTextureLoads(tCD_Handle* handles,
+                                int* states,
+                                int maxLoads) {
+    int numLoads = std::min<int>(maxLoads, finishedLoads.size());
+    for (int i = 0; i < numLoads; ++i) {
+        handles[i] = finishedLoads[i].first;
+        states[i] = finishedLoads[i].second;
+    }
+    finishedLoads.erase(finishedLoads.begin(), finishedLoads.begin() + numLoads);
+    return numLoads;
 }
 
 void dRenderer2DDestroyTexture(tCD_Handle texture) {
-    textures[texture].free();
+    auto pending = pendingLoads.find(texture);
+    if (pending != pendingLoads.end()) {
+        pending->second = true;
+        setTextureState(texture, CD_TEXTURE_FAILED);
+        return;
+    }
+    if (textures[texture].isRegion) return;
+    textureCache->release(textures[texture].texture.get());
     textures.erase(texture);
+    setTextureState(texture, CD_TEXTURE_FAILED);
+}
+
+void dRenderer2DSetTextureBudget(size_t bytes) {
+    textureCache->setBudget(bytes);
+}
+
+void dRenderer2DGetTextureMemoryStats(dTextureMemoryStats2D* stats) {
+    stats->bytes = textureCache->bytes();
+    stats->referencedBytes = textureCache->referencedBytes();
+    stats->budget = textureCache->budget();
+    stats->numTextures = textureCache->numTextures();
+    stats->numReferenced = textureCache->numReferenced();
+    stats->hits = textureCache->hits();
+    stats->misses = textureCache->misses();
+    stats->evictions = textureCache->evictions();
+}
+
+bool dRenderer2DRetainTexture(const Texture* texture) {
+    return textureCache && textureCache->retain(texture);
+}
+
+bool dRenderer2DReleaseTexture(const Texture* texture) {
+    return textureCache && textureCache->release(texture);
 }
 
 DumbPtr<Texture>& dRenderer2DGetTexture(tCD_Handle texture) {
+    return textures[texture].texture;
+}
+
+const CDTexture2D& dRenderer2DGetTextureRegion(tCD_Handle texture) {
     return textures[texture];
 }
 
+tCD_Handle dRenderer2DMakeTextureRegion(const DumbPtr<Texture>& texture,
+                                        int x, int y, int w, int h) {
+    tCD_Handle handle = textures.insert({texture, true, x, y, w, h});
+    setTextureState(handle, CD_TEXTURE_LOADED);
+    return handle;
+}
+
+void dRenderer2DDestroyTextureRegion(tCD_Handle texture) {
+    textures.erase(texture);
+    setTextureState(texture, CD_TEXTURE_FAILED);
+}
+
 tCD_Handle dRenderer2DMakeRenderComponent(tCD_Handle transform,
                                           tCD_Handle texture,
                                           tCD_RenderLayer layer) {
-    return renderComponents.insert(
-        renderer->makeRenderComponent(dTransform2GetTransformPtr(transform),
-                                      textures[texture],
-                                      (RenderLayer)layer)
-    );
+    auto& tex = textures[texture];
+    auto rcomp = renderer->makeRenderComponent(dTransform2GetTransformPtr(transform),
+                                               tex.texture,
+                                               (RenderLayer)layer);
+    if (tex.isRegion) clipToTexture(rcomp, tex);
+
+    tCD_Handle handle = renderComponents.insert(rcomp);
+    textureCache->retain(tex.texture.get());
+    componentSprites[handle] = tex.texture.get();
+    return handle;
 }
 
 void dRenderer2DDestroyRenderComponent(tCD_Handle renderComponent) {
+    textureCache->release(componentSprites[renderComponent]);
+    componentSprites.erase(renderComponent);
     renderComponents[renderComponent].free();
     renderComponents.erase(renderComponent);
 }
@@ -96,7 +578,15 @@ dRenderComponent2DGetRenderComponent(tCD_Handle renderComponent) {
 
 void dRenderComponent2DSetSprite(tCD_Handle renderComponent,
                                  tCD_Handle texture) {
-    renderComponents[renderComponent]->setSprite(textures[texture]);
+    auto& rcomp = renderComponents[renderComponent];
+    auto& sprite = componentSprites[renderComponent];
+    textureCache->retain(textures[texture].texture.get());
+    textureCache->release(sprite);
+    sprite = textures[texture].texture.get();
+
+    rcomp->setSprite(textures[texture].texture);
+    // the previous sprite's clip would otherwise stay in place
+    clipToTexture(rcomp, textures[texture]);
 }
 
 tCD_RenderLayer dRenderComponent2DGetLayer(tCD_Handle renderComponent) {
@@ -104,7 +594,8 @@ tCD_RenderLayer dRenderComponent2DGetLayer(tCD_Handle renderComponent) {
 }
 void dRenderComponent2DSetLayer(tCD_Handle renderComponent,
                                 tCD_RenderLayer newLayer) {
-    renderComponents[renderComponent]->setLayer((RenderLayer)newLayer);
+    renderer->setLayer(renderComponents[renderComponent].get(),
+                       (RenderLayer)newLayer);
 }
 
 dVector2f dRenderComponent2DGetPivot(tCD_Handle renderComponent) {
@@ -153,3 +644,10 @@ TextureFactory* dGetTextureFactory() {
 Renderer2D* dRenderer2DGetRenderer() {
     return renderer;
 }
+
+SDL_Renderer* dRenderer2DGetSDLRenderer() {
+    auto sdlRenderer = dEngine2DGetSDLRenderer();
+    if (!sdlRenderer)
+        Log::log("Failed to get the SDL renderer! Was the engine initialized?");
+    return sdlRenderer;
+}
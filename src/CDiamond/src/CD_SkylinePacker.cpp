@@ -0,0 +1,99 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "CD_SkylinePacker.h"
+
+#include <climits>
+
+CDSkylinePacker::CDSkylinePacker(int width, int height)
+    : width(width), height(height), maxX(0), maxY(0) {
+    skyline.push_back({0, 0, width});
+}
+
+bool CDSkylinePacker::insert(int w, int h, int& x, int& y) {
+    int bestBottom = INT_MAX;
+    int bestWidth = INT_MAX;
+    size_t bestIndex = skyline.size();
+
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        int fitY = fit(i, w, h);
+        if (fitY < 0) continue;
+
+        // prefer the highest bottom edge, then the narrowest segment
+        // so that wide gaps are left for wide rectangles.
+        if (fitY + h < bestBottom ||
+            (fitY + h == bestBottom && skyline[i].width < bestWidth)) {
+            bestBottom = fitY + h;
+            bestWidth = skyline[i].width;
+            bestIndex = i;
+            x = skyline[i].x;
+            y = fitY;
+        }
+    }
+
+    if (bestIndex == skyline.size()) return false;
+
+    place(bestIndex, x, y, w, h);
+    return true;
+}
+
+int CDSkylinePacker::fit(size_t i, int w, int h) const {
+    int x = skyline[i].x;
+    if (x + w > width) return -1;
+
+    // the rectangle rests on the highest segment underneath it
+    int y = skyline[i].y;
+    int widthLeft = w;
+    while (widthLeft > 0) {
+        if (skyline[i].y > y) y = skyline[i].y;
+        if (y + h > height) return -1;
+        widthLeft -= skyline[i].width;
+        ++i;
+    }
+    return y;
+}
+
+void CDSkylinePacker::place(size_t i, int x, int y, int w, int h) {
+    skyline.insert(skyline.begin() + i, {x, y + h, w});
+
+    // shrink or remove the segments now covered by the new one
+    for (size_t j = i + 1; j < skyline.size(); ) {
+        int prevEnd = skyline[j - 1].x + skyline[j - 1].width;
+        if (skyline[j].x >= prevEnd) break;
+
+        int shrink = prevEnd - skyline[j].x;
+        skyline[j].x += shrink;
+        skyline[j].width -= shrink;
+        if (skyline[j].width > 0) break;
+
+        skyline.erase(skyline.begin() + j);
+    }
+
+    // merge neighboring segments at the same height
+    for (size_t j = 0; j + 1 < skyline.size(); ) {
+        if (skyline[j].y == skyline[j + 1].y) {
+            skyline[j].width += skyline[j + 1].width;
+            skyline.erase(skyline.begin() + j + 1);
+        }
+        else {
+            ++j;
+        }
+    }
+
+    if (x + w > maxX) maxX = x + w;
+    if (y + h > maxY) maxY = y + h;
+}
@@ -0,0 +1,49 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "CD_SystemRegistry.h"
+
+#include <algorithm>
+#include <chrono>
+
+tCD_Handle CDSystemRegistry::addSystem(const std::string& name, int order, UpdateFunc fn) {
+    // after every system with the same or a lower order
+    auto pos = std::upper_bound(systems.begin(), systems.end(), order,
+                                [](int order, const System& system) {
+                                    return order < system.order;
+                                });
+    tCD_Handle handle = nextHandle++;
+    systems.insert(pos, System{handle, name, order, fn, 0});
+    return handle;
+}
+
+void CDSystemRegistry::removeSystem(tCD_Handle system) {
+    for (auto i = systems.begin(); i != systems.end(); ++i) {
+        if (i->handle == system) {
+            systems.erase(i);
+            return;
+        }
+    }
+}
+
+void CDSystemRegistry::update(tD_delta delta) {
+    for (auto& system : systems) {
+        auto start = std::chrono::steady_clock::now();
+        system.update(delta);
+        auto end = std::chrono::steady_clock::now();
+        system.timeMs = std::chrono::duration<float, std::milli>(end - start).count();
+    }
+}
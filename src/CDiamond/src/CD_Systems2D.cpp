@@ -0,0 +1,65 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "CD_Systems2D.h"
+
+#include <cstring>
+#include "CD_Animation2D.h"
+#include "CD_Mover2D.h"
+#include "CD_Node2D.h"
+#include "CD_ParticleSystem2D.h"
+#include "CD_SystemRegistry.h"
+#include "CD_Tween2D.h"
+
+static CDSystemRegistry* registry = nullptr;
+
+bool dSystems2DInit() {
+    if (!registry) {
+        registry = new CDSystemRegistry();
+        registry->addSystem("movers", CD_SYSTEM_ORDER_MOVERS, dMover2DUpdate);
+        registry->addSystem("tweens", CD_SYSTEM_ORDER_TWEENS, dTween2DUpdate);
+        registry->addSystem("nodes", CD_SYSTEM_ORDER_NODES,
+                            [](tD_delta) { dNode2DUpdate(); });
+        registry->addSystem("animation", CD_SYSTEM_ORDER_ANIMATION, dAnimation2DUpdate);
+        registry->addSystem("particles", CD_SYSTEM_ORDER_PARTICLES, dParticleSystem2DUpdate);
+    }
+    return true;
+}
+
+void dSystems2DDestroy() {
+    delete registry;
+    registry = nullptr;
+}
+
+void dSystems2DUpdate(tD_delta delta) {
+    if (registry) registry->update(delta);
+}
+
+int dSystems2DGetTimings(dSystemTiming2D* timings, int maxTimings) {
+    if (!registry) return 0;
+
+    int numSystems = registry->size();
+    for (int i = 0; i < numSystems && i < maxTimings; ++i) {
+        std::strncpy(timings[i].name, registry->getName(i).c_str(), CD_SYSTEM_NAME_SIZE - 1);
+        timings[i].name[CD_SYSTEM_NAME_SIZE - 1] = '\0';
+        timings[i].timeMs = registry->getTimeMs(i);
+    }
+    return numSystems;
+}
+
+CDSystemRegistry& dSystems2DGetRegistry() {
+    return *registry;
+}
@@ -0,0 +1,193 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "CD_TextureAtlas2D.h"
+
+#include <algorithm>
+#include <vector>
+#include "SDL.h"
+#include "SDL_image.h"
+#include "duSwapVector.h"
+#include "D_Log.h"
+#include "D_SDLTexture.h"
+#include "CD_Renderer2D.h"
+#include "CD_SkylinePacker.h"
+using namespace Diamond;
+
+// sprites are padded apart so that filtering
+// doesn't bleed neighboring sprites into each other.
+static const int SPRITE_PADDING = 1;
+
+struct CDTextureAtlas2D {
+    std::vector<DumbPtr<Texture> > pages;
+    std::vector<tCD_Handle> sprites;
+};
+
+static SwapVector<CDTextureAtlas2D, tCD_Handle> atlases;
+
+struct SpritePlacement {
+    SDL_Surface* surface;
+    int page;
+    int x, y;
+};
+
+static void freeAtlas(CDTextureAtlas2D& atlas) {
+    for (auto sprite : atlas.sprites) {
+        if (sprite >= 0) dRenderer2DDestroyTextureRegion(sprite);
+    }
+    for (auto& page : atlas.pages) {
+        page.free();
+    }
+}
+
+static DumbPtr<Texture> makePage(SDL_Renderer* sdlRenderer,
+                                 const std::vector<SpritePlacement>& sprites,
+                                 int page, int width, int height) {
+    auto surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32,
+                                                  SDL_PIXELFORMAT_RGBA32);
+    if (!surface) return nullptr;
+
+    // starts out fully transparent
+    SDL_FillRect(surface, nullptr, 0);
+
+    for (auto& sprite : sprites) {
+        if (sprite.page != page) continue;
+        SDL_Rect dest = {sprite.x, sprite.y, sprite.surface->w, sprite.surface->h};
+        SDL_BlitSurface(sprite.surface, nullptr, surface, &dest);
+    }
+
+    auto texture = SDL_CreateTextureFromSurface(sdlRenderer, surface);
+    SDL_FreeSurface(surface);
+    if (!texture) return nullptr;
+
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return DumbPtr<Texture>(new SDLTexture(texture, width, height));
+}
+
+tCD_Handle dTextureAtlas2DLoad(char** paths,
+                               int numPaths,
+                               int pageSize,
+                               tCD_Handle* textures) {
+    auto sdlRenderer = dRenderer2DGetSDLRenderer();
+    std::vector<SpritePlacement> sprites(numPaths, {nullptr, -1, 0, 0});
+
+    for (int i = 0; i < numPaths; ++i) {
+        textures[i] = CD_INVALID_HANDLE;
+
+        auto image = IMG_Load(paths[i]);
+        if (!image) {
+            Log::log("Failed to load atlas image " + std::string(paths[i]) +
+                     "! SDL_image Error: " + std::string(IMG_GetError()));
+            continue;
+        }
+
+        // blit sprite pixels onto the page as they are,
+        // instead of blending them with the empty page.
+        sprites[i].surface = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(image);
+        if (sprites[i].surface)
+            SDL_SetSurfaceBlendMode(sprites[i].surface, SDL_BLENDMODE_NONE);
+    }
+
+    // packing the tallest sprites first leaves the least wasted space
+    std::vector<int> order;
+    for (int i = 0; i < numPaths; ++i) {
+        if (sprites[i].surface) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&sprites](int a, int b) {
+        return sprites[a].surface->h > sprites[b].surface->h;
+    });
+
+    std::vector<CDSkylinePacker> packers;
+    for (auto i : order) {
+        auto& sprite = sprites[i];
+        // a sprite that reaches the edge of the page has no neighbor
+        // past that edge, so it isn't padded there.
+        int w = std::min(sprite.surface->w + SPRITE_PADDING, pageSize);
+        int h = std::min(sprite.surface->h + SPRITE_PADDING, pageSize);
+
+        for (size_t page = 0; page < packers.size() && sprite.page < 0; ++page) {
+            if (packers[page].insert(w, h, sprite.x, sprite.y))
+                sprite.page = page;
+        }
+
+        if (sprite.page < 0) {
+            packers.emplace_back(pageSize, pageSize);
+            if (packers.back().insert(w, h, sprite.x, sprite.y)) {
+                sprite.page = packers.size() - 1;
+            }
+            else {
+                packers.pop_back();
+                Log::log("Atlas image " + std::string(paths[i]) +
+                         " is bigger than the atlas page size!");
+            }
+        }
+    }
+
+    CDTextureAtlas2D atlas;
+    bool success = sdlRenderer && !packers.empty();
+
+    for (size_t page = 0; page < packers.size() && success; ++page) {
+        // pages are only as big as the sprites packed into them
+        auto texture = makePage(sdlRenderer, sprites, page,
+                                packers[page].usedWidth(),
+                                packers[page].usedHeight());
+        if (texture)
+            atlas.pages.push_back(texture);
+        else
+            success = false;
+    }
+
+    if (success) {
+        for (int i = 0; i < numPaths; ++i) {
+            auto& sprite = sprites[i];
+            if (sprite.page < 0) continue;
+            textures[i] = dRenderer2DMakeTextureRegion(atlas.pages[sprite.page],
+                                                       sprite.x, sprite.y,
+                                                       sprite.surface->w,
+                                                       sprite.surface->h);
+            atlas.sprites.push_back(textures[i]);
+        }
+    }
+    else {
+        Log::log("Failed to make atlas pages! SDL Error: " + std::string(SDL_GetError()));
+        freeAtlas(atlas);
+    }
+
+    for (auto& sprite : sprites) {
+        SDL_FreeSurface(sprite.surface);
+    }
+
+    if (!success) return CD_INVALID_HANDLE;
+    return atlases.insert(atlas);
+}
+
+int dTextureAtlas2DGetNumPages(tCD_Handle atlas) {
+    return atlases[atlas].pages.size();
+}
+
+void dTextureAtlas2DDestroy(tCD_Handle atlas) {
+    freeAtlas(atlases[atlas]);
+    atlases.erase(atlas);
+}
+
+void dTextureAtlas2DDestroyAll() {
+    for (auto& atlas : atlases) {
+        freeAtlas(atlas);
+    }
+    atlases.clear();
+}
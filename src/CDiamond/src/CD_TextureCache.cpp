@@ -0,0 +1,108 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "CD_TextureCache.h"
+
+using namespace Diamond;
+
+CDTextureCache::CDTextureCache(size_t budget)
+    : maxBytes(budget),
+      totalBytes(0),
+      unreferencedBytes(0),
+      numHits(0),
+      numMisses(0),
+      numEvictions(0) {}
+
+CDTextureCache::~CDTextureCache() {
+    for (auto& path : paths) {
+        delete path.second;
+    }
+}
+
+Texture* CDTextureCache::acquire(const std::string& path) {
+    auto cached = paths.find(path);
+    if (cached == paths.end()) {
+        ++numMisses;
+        return nullptr;
+    }
+
+    ++numHits;
+    retain(cached->second);
+    return cached->second;
+}
+
+Texture* CDTextureCache::acquireUncounted(const std::string& path) {
+    auto cached = paths.find(path);
+    if (cached == paths.end()) return nullptr;
+
+    retain(cached->second);
+    return cached->second;
+}
+
+void CDTextureCache::insert(const std::string& path, Texture* texture, size_t bytes) {
+    paths[path] = texture;
+    entries[texture] = {path, bytes, 1, unreferenced.end()};
+    totalBytes += bytes;
+    evict();
+}
+
+bool CDTextureCache::retain(const Texture* texture) {
+    auto entry = entries.find(texture);
+    if (entry == entries.end()) return false;
+
+    if (entry->second.refs++ == 0) {
+        unreferenced.erase(entry->second.lruPos);
+        unreferencedBytes -= entry->second.bytes;
+    }
+    return true;
+}
+
+bool CDTextureCache::release(const Texture* texture) {
+    auto entry = entries.find(texture);
+    if (entry == entries.end()) return false;
+
+    if (--entry->second.refs == 0) {
+        unreferenced.push_front(texture);
+        entry->second.lruPos = unreferenced.begin();
+        unreferencedBytes += entry->second.bytes;
+        evict();
+    }
+    return true;
+}
+
+void CDTextureCache::setBudget(size_t budget) {
+    maxBytes = budget;
+    evict();
+}
+
+void CDTextureCache::evict() {
+    while (totalBytes > maxBytes && !unreferenced.empty()) {
+        auto texture = unreferenced.back();
+        unreferenced.pop_back();
+
+        auto entry = entries.find(texture);
+        totalBytes -= entry->second.bytes;
+        unreferencedBytes -= entry->second.bytes;
+
+        auto owned = paths[entry->second.path];
+        paths.erase(entry->second.path);
+        entries.erase(entry);
+        delete owned;
+
+        ++numEvictions;
+    }
+}
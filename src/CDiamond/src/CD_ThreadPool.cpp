@@ -0,0 +1,102 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "CD_ThreadPool.h"
+
+#include <algorithm>
+
+CDThreadPool::CDThreadPool(unsigned int numThreads) : stopping(false) {
+    if (numThreads == 0) numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0) numThreads = 1;
+
+    for (unsigned int i = 0; i < numThreads; ++i) {
+        workers.emplace_back(&CDThreadPool::work, this);
+    }
+}
+
+CDThreadPool::~CDThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        tasks.clear();
+    }
+    taskReady.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void CDThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+void CDThreadPool::parallelFor(size_t count, size_t minPerRange,
+                               const std::function<void(size_t begin, size_t end)>& fn) {
+    size_t numRanges = std::min<size_t>(workers.size() + 1,
+                                        count / std::max<size_t>(minPerRange, 1));
+    if (numRanges <= 1) {
+        if (count > 0) fn(0, count);
+        return;
+    }
+
+    std::mutex doneMutex;
+    std::condition_variable doneCV;
+    size_t remaining = numRanges - 1;
+
+    size_t rangeSize = count / numRanges;
+    size_t extra = count % numRanges;
+    size_t begin = 0;
+    for (size_t i = 0; i < numRanges; ++i) {
+        size_t end = begin + rangeSize + (i < extra ? 1 : 0);
+
+        // the calling thread takes the last range
+        if (i == numRanges - 1) {
+            fn(begin, end);
+            break;
+        }
+
+        submit([&, begin, end] {
+            fn(begin, end);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0) doneCV.notify_one();
+        });
+        begin = end;
+    }
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCV.wait(lock, [&] { return remaining == 0; });
+}
+
+void CDThreadPool::work() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping) return;
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,415 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "CD_Tween2D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "duMath.h"
+#include "D_RenderComponent2D.h"
+#include "D_Transform2.h"
+#include "CD_Renderer2D.h"
+#include "CD_Transform2.h"
+using namespace Diamond;
+
+struct CDTweenValue {
+    float v[3];
+};
+
+/**
+ * Tweens in parallel arrays. Running tweens come first, then the tweens
+ * that are waiting for the tweens before them in a sequence.
+ * Removing a tween moves the last one into its place.
+ */
+struct CDTweens {
+    static const uint32_t NO_INDEX = UINT32_MAX;
+
+    // a DTransform2 or a RenderComponent2D, depending on the property
+    std::vector<void*> targets;
+    std::vector<uint8_t> properties;
+    std::vector<uint8_t> easings;
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> started;
+    // set while a yoyo tween plays backwards
+    std::vector<uint8_t> reversed;
+    std::vector<tD_delta> elapsed;
+    std::vector<tD_delta> delays;
+    std::vector<tD_delta> durations;
+    std::vector<int32_t> loopsLeft;
+    // to as given, and the values tweened from and to once started
+    std::vector<CDTweenValue> defTos;
+    std::vector<CDTweenValue> froms;
+    std::vector<CDTweenValue> tos;
+    // the tweens after and before in a sequence, or CD_INVALID_HANDLE
+    std::vector<tCD_Handle> nexts;
+    std::vector<tCD_Handle> prevs;
+    std::vector<tCD_Handle> handles;
+    // the tweens before this index are running
+    uint32_t numRunning = 0;
+
+    // By handle.
+    std::vector<uint32_t> indices;
+    std::vector<tCD_Handle> freeHandles;
+    // freed since the last update, reusable after the next one
+    std::vector<tCD_Handle> releasedHandles;
+
+    // the tweens that finished in the last update
+    std::vector<tCD_Handle> finished;
+
+    bool contains(tCD_Handle tween) const {
+        return tween >= 0 && (size_t)tween < indices.size() && indices[tween] != NO_INDEX;
+    }
+
+    void swap(uint32_t a, uint32_t b) {
+        std::swap(targets[a], targets[b]);
+        std::swap(properties[a], properties[b]);
+        std::swap(easings[a], easings[b]);
+        std::swap(flags[a], flags[b]);
+        std::swap(started[a], started[b]);
+        std::swap(reversed[a], reversed[b]);
+        std::swap(elapsed[a], elapsed[b]);
+        std::swap(delays[a], delays[b]);
+        std::swap(durations[a], durations[b]);
+        std::swap(loopsLeft[a], loopsLeft[b]);
+        std::swap(defTos[a], defTos[b]);
+        std::swap(froms[a], froms[b]);
+        std::swap(tos[a], tos[b]);
+        std::swap(nexts[a], nexts[b]);
+        std::swap(prevs[a], prevs[b]);
+        std::swap(handles[a], handles[b]);
+        indices[handles[a]] = a;
+        indices[handles[b]] = b;
+    }
+
+    void popBack() {
+        targets.pop_back();
+        properties.pop_back();
+        easings.pop_back();
+        flags.pop_back();
+        started.pop_back();
+        reversed.pop_back();
+        elapsed.pop_back();
+        delays.pop_back();
+        durations.pop_back();
+        loopsLeft.pop_back();
+        defTos.pop_back();
+        froms.pop_back();
+        tos.pop_back();
+        nexts.pop_back();
+        prevs.pop_back();
+        handles.pop_back();
+    }
+
+    // Returns the tween's new index.
+    uint32_t run(uint32_t index) {
+        if (index < numRunning) return index;
+        swap(index, numRunning);
+        return numRunning++;
+    }
+
+    // Returns the tween's new index.
+    uint32_t hold(uint32_t index) {
+        if (index >= numRunning) return index;
+        swap(index, --numRunning);
+        return numRunning;
+    }
+
+    // Frees the tween, leaving the tweens before and after it unlinked.
+    void remove(tCD_Handle tween) {
+        uint32_t index = hold(indices[tween]);
+        if (nexts[index] != CD_INVALID_HANDLE)
+            prevs[indices[nexts[index]]] = CD_INVALID_HANDLE;
+        if (prevs[index] != CD_INVALID_HANDLE)
+            nexts[indices[prevs[index]]] = CD_INVALID_HANDLE;
+
+        swap(index, handles.size() - 1);
+        popBack();
+        indices[tween] = NO_INDEX;
+        releasedHandles.push_back(tween);
+    }
+};
+
+const uint32_t CDTweens::NO_INDEX;
+
+static CDTweens tweens;
+
+static int numComponents(int property) {
+    switch (property) {
+        case CD_TWEEN_POSITION:
+        case CD_TWEEN_SCALE:
+            return 2;
+        case CD_TWEEN_COLOR:
+            return 3;
+        default:
+            return 1;
+    }
+}
+
+static uint8_t toByte(float value) {
+    return (uint8_t)std::min(255.0f, std::max(0.0f, std::round(value)));
+}
+
+static float ease(int easing, float t) {
+    const float pi = (float)Math::PI;
+    switch (easing) {
+        case CD_EASE_QUAD_IN:
+            return t * t;
+        case CD_EASE_QUAD_OUT:
+            return t * (2 - t);
+        case CD_EASE_QUAD_IN_OUT:
+            return t < 0.5f ? 2 * t * t : -1 + (4 - 2 * t) * t;
+        case CD_EASE_CUBIC_IN:
+            return t * t * t;
+        case CD_EASE_CUBIC_OUT: {
+            float u = t - 1;
+            return u * u * u + 1;
+        }
+        case CD_EASE_CUBIC_IN_OUT: {
+            float u = 2 * t - 2;
+            return t < 0.5f ? 4 * t * t * t : 0.5f * u * u * u + 1;
+        }
+        case CD_EASE_SINE_IN:
+            return 1 - std::cos(t * pi / 2);
+        case CD_EASE_SINE_OUT:
+            return std::sin(t * pi / 2);
+        case CD_EASE_SINE_IN_OUT:
+            return 0.5f * (1 - std::cos(t * pi));
+        case CD_EASE_BACK_OUT: {
+            const float s = 1.70158f;
+            float u = t - 1;
+            return u * u * ((s + 1) * u + s) + 1;
+        }
+        case CD_EASE_ELASTIC_OUT:
+            if (t <= 0 || t >= 1) return t;
+            return std::pow(2.0f, -10 * t) * std::sin((10 * t - 0.75f) * (2 * pi / 3)) + 1;
+        case CD_EASE_BOUNCE_OUT: {
+            const float n = 7.5625f, d = 2.75f;
+            if (t < 1 / d) return n * t * t;
+            if (t < 2 / d) { t -= 1.5f / d; return n * t * t + 0.75f; }
+            if (t < 2.5f / d) { t -= 2.25f / d; return n * t * t + 0.9375f; }
+            t -= 2.625f / d;
+            return n * t * t + 0.984375f;
+        }
+        default:
+            return t;
+    }
+}
+
+// Takes the value the tween at index tween starts from out of its target.
+static void start(uint32_t tween) {
+    CDTweenValue& from = tweens.froms[tween];
+    switch (tweens.properties[tween]) {
+        case CD_TWEEN_POSITION: {
+            auto transform = static_cast<DTransform2*>(tweens.targets[tween]);
+            from = {{transform->position.x, transform->position.y, 0}};
+            break;
+        }
+        case CD_TWEEN_ROTATION:
+            from = {{static_cast<DTransform2*>(tweens.targets[tween])->rotation, 0, 0}};
+            break;
+        case CD_TWEEN_SCALE: {
+            auto transform = static_cast<DTransform2*>(tweens.targets[tween]);
+            from = {{transform->scale.x, transform->scale.y, 0}};
+            break;
+        }
+        case CD_TWEEN_COLOR: {
+            RGB color = static_cast<RenderComponent2D*>(tweens.targets[tween])->getColor();
+            from = {{(float)color.r, (float)color.g, (float)color.b}};
+            break;
+        }
+        case CD_TWEEN_ALPHA:
+            from = {{(float)static_cast<RenderComponent2D*>(tweens.targets[tween])->getAlpha(), 0, 0}};
+            break;
+    }
+
+    tweens.tos[tween] = tweens.defTos[tween];
+    if (tweens.flags[tween] & CD_TWEEN_RELATIVE) {
+        for (int i = 0; i < 3; ++i) tweens.tos[tween].v[i] += from.v[i];
+    }
+    tweens.started[tween] = true;
+}
+
+// Sets the target's property to the given fraction of the way from from to to.
+static void apply(uint32_t tween, float amount) {
+    const CDTweenValue& from = tweens.froms[tween];
+    const CDTweenValue& to = tweens.tos[tween];
+    float v[3];
+    for (int i = 0; i < 3; ++i) v[i] = from.v[i] + (to.v[i] - from.v[i]) * amount;
+
+    switch (tweens.properties[tween]) {
+        case CD_TWEEN_POSITION: {
+            auto transform = static_cast<DTransform2*>(tweens.targets[tween]);
+            transform->position.x = v[0];
+            transform->position.y = v[1];
+            break;
+        }
+        case CD_TWEEN_ROTATION:
+            static_cast<DTransform2*>(tweens.targets[tween])->rotation = v[0];
+            break;
+        case CD_TWEEN_SCALE: {
+            auto transform = static_cast<DTransform2*>(tweens.targets[tween]);
+            transform->scale.x = v[0];
+            transform->scale.y = v[1];
+            break;
+        }
+        case CD_TWEEN_COLOR:
+            static_cast<RenderComponent2D*>(tweens.targets[tween])->setColor(
+                {toByte(v[0]), toByte(v[1]), toByte(v[2])}
+            );
+            break;
+        case CD_TWEEN_ALPHA:
+            static_cast<RenderComponent2D*>(tweens.targets[tween])->setAlpha(toByte(v[0]));
+            break;
+    }
+}
+
+static void destroyChain(tCD_Handle tween) {
+    while (tweens.contains(tween)) {
+        tCD_Handle next = tweens.nexts[tweens.indices[tween]];
+        tweens.remove(tween);
+        tween = next;
+    }
+}
+
+static void destroyTargetTweens(const void* target) {
+    std::vector<tCD_Handle> targetTweens;
+    for (size_t i = 0; i < tweens.handles.size(); ++i) {
+        if (tweens.targets[i] == target) targetTweens.push_back(tweens.handles[i]);
+    }
+    for (tCD_Handle tween : targetTweens) destroyChain(tween);
+}
+
+void dTween2DDestroyAll() {
+    tweens = CDTweens();
+}
+
+tCD_Handle dTween2DMakeTween(tCD_Handle target, const dTweenDef2D* def) {
+    tCD_Handle tween;
+    if (!tweens.freeHandles.empty()) {
+        tween = tweens.freeHandles.back();
+        tweens.freeHandles.pop_back();
+    }
+    else {
+        tween = tweens.indices.size();
+        tweens.indices.push_back(CDTweens::NO_INDEX);
+    }
+
+    void* targetPtr;
+    if (def->property == CD_TWEEN_COLOR || def->property == CD_TWEEN_ALPHA)
+        targetPtr = dRenderComponent2DGetRenderComponent(target).get();
+    else
+        targetPtr = dTransform2GetTransformPtr(target).get();
+
+    CDTweenValue to = {{0, 0, 0}};
+    for (int i = 0; i < numComponents(def->property); ++i) to.v[i] = def->to[i];
+
+    uint32_t index = tweens.handles.size();
+    tweens.targets.push_back(targetPtr);
+    tweens.properties.push_back(def->property);
+    tweens.easings.push_back(def->easing);
+    tweens.flags.push_back(def->flags);
+    tweens.started.push_back(false);
+    tweens.reversed.push_back(false);
+    tweens.elapsed.push_back(0);
+    tweens.delays.push_back(std::max(0, def->delay));
+    // at least a millisecond, so that looping tweens always take time
+    tweens.durations.push_back(std::max(1, def->duration));
+    tweens.loopsLeft.push_back(def->loops);
+    tweens.defTos.push_back(to);
+    tweens.froms.push_back(to);
+    tweens.tos.push_back(to);
+    tweens.nexts.push_back(CD_INVALID_HANDLE);
+    tweens.prevs.push_back(CD_INVALID_HANDLE);
+    tweens.handles.push_back(tween);
+    tweens.indices[tween] = index;
+
+    tweens.run(index);
+    return tween;
+}
+
+void dTween2DThen(tCD_Handle tween, tCD_Handle next) {
+    uint32_t nextIndex = tweens.hold(tweens.indices[next]);
+    tweens.elapsed[nextIndex] = 0;
+    tweens.started[nextIndex] = false;
+    tweens.prevs[nextIndex] = tween;
+    tweens.nexts[tweens.indices[tween]] = next;
+}
+
+void dTween2DDestroyTween(tCD_Handle tween) {
+    destroyChain(tween);
+}
+
+void dTween2DDestroyTransformTweens(tCD_Handle transform) {
+    destroyTargetTweens(dTransform2GetTransformPtr(transform).get());
+}
+
+void dTween2DDestroyRenderComponentTweens(tCD_Handle renderComponent) {
+    destroyTargetTweens(dRenderComponent2DGetRenderComponent(renderComponent).get());
+}
+
+int dTween2DGetFinished(tCD_Handle* finishedTweens, int maxTweens) {
+    int numFinished = tweens.finished.size();
+    for (int i = 0; i < numFinished && i < maxTweens; ++i) {
+        finishedTweens[i] = tweens.finished[i];
+    }
+    return numFinished;
+}
+
+void dTween2DUpdate(tD_delta delta) {
+    tweens.finished.clear();
+    tweens.freeHandles.insert(tweens.freeHandles.end(),
+                              tweens.releasedHandles.begin(), tweens.releasedHandles.end());
+    tweens.releasedHandles.clear();
+
+    uint32_t count = tweens.numRunning;
+    tD_delta* elapsed = tweens.elapsed.data();
+    for (uint32_t i = 0; i < count; ++i) {
+        elapsed[i] += delta;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (elapsed[i] < tweens.delays[i]) continue;
+        if (!tweens.started[i]) start(i);
+
+        tD_delta duration = tweens.durations[i];
+        tD_delta time = elapsed[i] - tweens.delays[i];
+        bool done = false;
+        while (time >= duration) {
+            if (tweens.loopsLeft[i] == 0) {
+                time = duration;
+                done = true;
+                break;
+            }
+            if (tweens.loopsLeft[i] > 0) --tweens.loopsLeft[i];
+            elapsed[i] -= duration;
+            time -= duration;
+            if (tweens.flags[i] & CD_TWEEN_YOYO) tweens.reversed[i] = !tweens.reversed[i];
+        }
+
+        float t = (float)time / duration;
+        if (tweens.reversed[i]) t = 1 - t;
+        apply(i, ease(tweens.easings[i], t));
+        if (done) tweens.finished.push_back(tweens.handles[i]);
+    }
+
+    // the tweens that follow finished ones start with the next update
+    for (tCD_Handle tween : tweens.finished) {
+        tCD_Handle next = tweens.nexts[tweens.indices[tween]];
+        tweens.remove(tween);
+        if (next != CD_INVALID_HANDLE) tweens.run(tweens.indices[next]);
+    }
+}
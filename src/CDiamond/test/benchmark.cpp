@@ -0,0 +1,495 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+// Benchmarks for CDiamond's data structures and physics.
+// Doesn't need the engine to be initialized.
+// Compares against the engine's Quantum2D physics world
+// if built with CD_BENCHMARK_QUANTUM.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include "CD_BodyTable.h"
+#include "CD_ECSWorld.h"
+#include "CD_NativeWorld2D.h"
+#include "CD_NodeTree2D.h"
+#include "CD_ThreadPool.h"
+#include "D_Entity.h"
+#ifdef CD_BENCHMARK_QUANTUM
+#include "D_QuantumWorld2D.h"
+#endif
+using namespace Diamond;
+
+// Stands in for a physics backend's rigidbody storage,
+// which is looked up by body ID.
+struct BenchBody {
+    Vector2<tD_pos> position;
+    tD_rot rotation;
+    Vector2<tD_pos> velocity;
+    float angVelocity;
+};
+
+// Returns the nanoseconds per body that the given sync takes, averaged over reps.
+template <typename F>
+static double timeSync(size_t numBodies, int reps, F sync) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) {
+        sync();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / reps / numBodies;
+}
+
+// Keeps the optimizer from dropping the syncs.
+static volatile double sink;
+
+static void benchBodySync(size_t numBodies) {
+    std::mt19937 rng(numBodies);
+
+    // transforms are allocated in pools and handed out in no particular order,
+    // so give the bodies scattered transforms
+    std::vector<DTransform2> transformPool(numBodies * 2);
+    std::vector<DTransform2*> transforms;
+    for (auto& transform : transformPool) {
+        transforms.push_back(&transform);
+    }
+    std::shuffle(transforms.begin(), transforms.end(), rng);
+    transforms.resize(numBodies);
+
+    std::vector<BenchBody> bodies(numBodies);
+    std::map<uint32_t, DTransform2*> pairs;
+    CDBodyTable table;
+    for (uint32_t id = 0; id < numBodies; ++id) {
+        pairs[id] = transforms[id];
+        table.add(id, transforms[id]);
+    }
+
+    // transforms stored as arrays in body order
+    std::vector<tD_pos> soaX(numBodies), soaY(numBodies);
+    std::vector<tD_rot> soaRot(numBodies);
+
+    int reps = std::max<int>(1, 20000000 / numBodies);
+
+    double mapTime = timeSync(numBodies, reps, [&] {
+        for (auto& pair : pairs) {
+            bodies[pair.first].position = pair.second->position;
+            bodies[pair.first].rotation = pair.second->rotation;
+        }
+        for (auto& pair : pairs) {
+            pair.second->position = bodies[pair.first].position;
+            pair.second->rotation = bodies[pair.first].rotation;
+        }
+    });
+
+    double denseTime = timeSync(numBodies, reps, [&] {
+        table.pullTransforms();
+        table.pushTransforms();
+    });
+
+    double soaTime = timeSync(numBodies, reps, [&] {
+        table.pullTransforms(soaX.data(), soaY.data(), soaRot.data());
+        table.pushTransforms(soaX.data(), soaY.data(), soaRot.data());
+    });
+
+    sink = bodies[0].position.x + soaX[0] + table.x()[0];
+
+    std::cout << std::setw(8) << numBodies
+              << std::setw(12) << mapTime
+              << std::setw(12) << denseTime
+              << std::setw(12) << soaTime << std::endl;
+}
+
+// Times a fixed-step frame's syncs (pull after the step, interpolate,
+// and restore before the next step) split across numThreads threads.
+static double timeParallelSync(size_t numBodies, unsigned int numThreads) {
+    std::mt19937 rng(numBodies);
+    std::vector<DTransform2> transformPool(numBodies * 2);
+    std::vector<DTransform2*> transforms;
+    for (auto& transform : transformPool) {
+        transforms.push_back(&transform);
+    }
+    std::shuffle(transforms.begin(), transforms.end(), rng);
+
+    CDBodyTable table;
+    for (uint32_t id = 0; id < numBodies; ++id) {
+        table.add(id, transforms[id]);
+    }
+
+    std::unique_ptr<CDThreadPool> pool;
+    if (numThreads > 1) {
+        pool.reset(new CDThreadPool(numThreads - 1));
+        table.setThreadPool(pool.get(), 4096);
+    }
+
+    int reps = std::max<int>(1, 20000000 / numBodies);
+    double time = timeSync(numBodies, reps, [&] {
+        table.restoreTransforms();
+        table.savePrevious();
+        table.pullTransforms();
+        table.interpolate(0.5f);
+    });
+    sink = table.x()[0];
+    return time;
+}
+
+static void benchParallelSync(size_t numBodies) {
+    std::cout << std::setw(8) << numBodies;
+    for (unsigned int numThreads : {1, 2, 4, 8}) {
+        std::cout << std::setw(12) << timeParallelSync(numBodies, numThreads);
+    }
+    std::cout << std::endl;
+}
+
+// Moves numBodies bodies with circle and box colliders around a world
+// sized so that each body has about the same room at every count.
+// Every staticEvery-th body is made by makeStatic instead, and stays put,
+// like level geometry (0 for none).
+// Returns the milliseconds that each physics step takes.
+template <typename MakeStatic>
+static double timePhysics(PhysicsWorld2D& world, size_t numBodies,
+                          size_t staticEvery, MakeStatic makeStatic,
+                          long& numCollisions) {
+    const int steps = 100;
+    const float spacing = 40;
+    float worldSize = spacing * std::sqrt((float)numBodies);
+
+    std::mt19937 rng(numBodies);
+    std::uniform_real_distribution<float> position(0, worldSize);
+    std::uniform_real_distribution<float> velocity(-0.1f, 0.1f);
+
+    std::vector<DTransform2> transforms(numBodies);
+    std::vector<DumbPtr<Rigidbody2D> > bodies;
+    std::vector<DumbPtr<Collider2D> > colliders;
+    numCollisions = 0;
+    auto onCollision = [&numCollisions](void*) { ++numCollisions; };
+
+    for (size_t i = 0; i < numBodies; ++i) {
+        transforms[i].position = Vector2<tD_pos>(position(rng), position(rng));
+        bool isStatic = staticEvery && i % staticEvery != 0;
+        auto body = isStatic ? makeStatic(transforms[i]) : world.makeRigidbody(transforms[i]);
+        if (!isStatic)
+            body->setVelocity(Vector2<tD_pos>(velocity(rng), velocity(rng)));
+        bodies.push_back(body);
+
+        if (i % 2)
+            colliders.push_back(world.makeCircleCollider(body, nullptr, onCollision, 10));
+        else
+            colliders.push_back(world.makeAABBCollider(body, nullptr, onCollision,
+                                                       Vector2<tD_pos>(20, 20)));
+    }
+
+    // let the world settle, ex. build its broadphase
+    world.update(16);
+    numCollisions = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        world.update(16);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (auto& collider : colliders) collider.free();
+    for (auto& body : bodies) body.free();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / steps;
+}
+
+static void benchPhysics(size_t numBodies) {
+    CDRigidbodyDef2D staticDef;
+    staticDef.type = CD_BODY_STATIC;
+
+    long nativeCollisions, staticCollisions;
+    double nativeTime, staticTime;
+    {
+        CDNativeWorld2D world;
+        world.init(Config());
+        nativeTime = timePhysics(world, numBodies, 0, [&](DTransform2& transform) {
+            return world.makeRigidbody(transform);
+        }, nativeCollisions);
+    }
+    {
+        CDNativeWorld2D world;
+        world.init(Config());
+        staticTime = timePhysics(world, numBodies, 5, [&](DTransform2& transform) {
+            return world.makeRigidbody(transform, staticDef);
+        }, staticCollisions);
+    }
+
+    std::cout << std::setw(8) << numBodies
+              << std::setw(12) << nativeTime
+              << std::setw(12) << staticTime;
+
+#ifdef CD_BENCHMARK_QUANTUM
+    // Quantum2D has no static bodies, so its level geometry just doesn't move
+    long quantumCollisions;
+    QuantumWorld2D world;
+    world.init(Config());
+    double quantumTime = timePhysics(world, numBodies, 5, [&](DTransform2& transform) {
+        return world.makeRigidbody(transform);
+    }, quantumCollisions);
+
+    std::cout << std::setw(12) << quantumTime;
+#endif
+
+    std::cout << std::endl;
+}
+
+// Fires numBullets circles through a crowded area, like a bullet-hell scene.
+// If filtered, bullets are given a category that their mask leaves out,
+// so that they're never tested against each other.
+// Returns the milliseconds that each physics step takes.
+static double timeBullets(size_t numBullets, bool filtered) {
+    const int steps = 100;
+    const float areaSize = 1000;
+
+    std::mt19937 rng(numBullets);
+    std::uniform_real_distribution<float> position(0, areaSize);
+    std::uniform_real_distribution<float> velocity(-0.2f, 0.2f);
+
+    CDNativeWorld2D world;
+    world.init(Config());
+    std::vector<DTransform2> transforms(numBullets);
+    std::vector<DumbPtr<Rigidbody2D> > bodies;
+    std::vector<DumbPtr<CircleCollider> > colliders;
+    long numCollisions = 0;
+    auto onCollision = [&numCollisions](void*) { ++numCollisions; };
+
+    for (size_t i = 0; i < numBullets; ++i) {
+        transforms[i].position = Vector2<tD_pos>(position(rng), position(rng));
+        auto body = world.makeRigidbody(transforms[i]);
+        body->setVelocity(Vector2<tD_pos>(velocity(rng), velocity(rng)));
+        bodies.push_back(body);
+
+        auto collider = world.makeCircleCollider(body, nullptr, onCollision, 4);
+        if (filtered) {
+            auto& shape = static_cast<CDNativeCircleCollider*>(collider.get())->shape;
+            world.setFilter(shape, 0, 2, ~2u);
+        }
+        colliders.push_back(collider);
+    }
+
+    world.update(16);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        world.update(16);
+    }
+    auto end = std::chrono::steady_clock::now();
+    sink = numCollisions;
+
+    for (auto& collider : colliders) collider.free();
+    for (auto& body : bodies) body.free();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / steps;
+}
+
+// Times updating a hierarchy of numNodes nodes in groups of eight:
+// a root, a child, a grandchild, and five children of the grandchild.
+// Every movingEvery-th root turns each update.
+// Returns the nanoseconds per node that each update takes.
+static double timeNodeUpdate(size_t numNodes, size_t movingEvery,
+                             unsigned int numThreads = 1) {
+    const size_t perRoot = 8;
+    std::vector<DTransform2> transforms(numNodes);
+    CDNodeTree2D tree;
+    std::vector<tCD_Handle> roots;
+    for (size_t i = 0; i < numNodes; ++i) {
+        transforms[i].position = Vector2<tD_pos>(i % 100, i / 100);
+        tCD_Handle node = tree.makeNode(&transforms[i]);
+        if (i % perRoot == 0) {
+            roots.push_back(node);
+        }
+        else {
+            size_t index = i % perRoot;
+            tree.addChild(index < 3 ? node - 1 : node - index + 2, node);
+        }
+    }
+    tree.update();
+
+    std::unique_ptr<CDThreadPool> pool;
+    if (numThreads > 1) {
+        pool.reset(new CDThreadPool(numThreads - 1));
+        tree.setThreadPool(pool.get(), 4096);
+    }
+
+    int reps = std::max<int>(1, 20000000 / numNodes);
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < reps; ++rep) {
+        for (size_t i = 0; i < roots.size(); i += movingEvery) {
+            transforms[i * perRoot].rotation += 1;
+        }
+        tree.update();
+    }
+    auto end = std::chrono::steady_clock::now();
+    sink = transforms.back().position.x;
+    return std::chrono::duration<double, std::nano>(end - start).count() / reps / numNodes;
+}
+
+struct BenchPosition { tD_pos x, y; };
+struct BenchVelocity { tD_pos x, y; };
+struct BenchHealth { int hp; };
+
+// Diamond::Entity's components, found by name and updated by virtual calls.
+class BenchPositionComponent : public Component {
+public:
+    BenchPosition position;
+};
+
+class BenchVelocityComponent : public Component {
+public:
+    BenchVelocityComponent(BenchPosition& position, BenchVelocity velocity)
+        : position(position), velocity(velocity) {}
+    void update(tD_delta delta) override {
+        position.x += velocity.x * delta;
+        position.y += velocity.y * delta;
+    }
+    BenchPosition& position;
+    BenchVelocity velocity;
+};
+
+// Times moving numEntities entities by their velocities, and looking up
+// each one's velocity, with Diamond::Entity and with CDECSWorld.
+// Every other entity also has a health component, so the ECS world
+// has two archetypes to go through.
+static void benchEntities(size_t numEntities) {
+    const int reps = std::max<int>(1, 20000000 / numEntities);
+
+    std::vector<Entity> entities(numEntities);
+    CDECSWorld world;
+    std::vector<tCD_Handle> handles;
+    for (size_t i = 0; i < numEntities; ++i) {
+        BenchVelocity velocity = {(tD_pos)(i % 7), (tD_pos)(i % 5)};
+
+        auto position = new BenchPositionComponent();
+        entities[i].addComponent("position", position);
+        entities[i].addComponent("velocity",
+            new BenchVelocityComponent(position->position, velocity));
+        if (i % 2) entities[i].addComponent("health", new Component());
+
+        tCD_Handle entity = world.makeEntity();
+        world.add<BenchPosition>(entity);
+        world.add<BenchVelocity>(entity, velocity);
+        if (i % 2) world.add<BenchHealth>(entity);
+        handles.push_back(entity);
+    }
+
+    double entityUpdate = timeSync(numEntities, reps, [&]() {
+        for (auto& entity : entities) entity.updateComponents(16);
+    });
+    double ecsUpdate = timeSync(numEntities, reps, [&]() {
+        world.eachArchetype<BenchPosition, BenchVelocity>(
+            [](size_t count, const tCD_Handle*,
+               BenchPosition* positions, BenchVelocity* velocities) {
+                for (size_t i = 0; i < count; ++i) {
+                    positions[i].x += velocities[i].x * 16;
+                    positions[i].y += velocities[i].y * 16;
+                }
+            });
+    });
+
+    double lookupSum = 0;
+    double entityLookup = timeSync(numEntities, reps, [&]() {
+        for (auto& entity : entities)
+            lookupSum += entity.getComponent<BenchVelocityComponent>("velocity")->velocity.x;
+    });
+    double ecsLookup = timeSync(numEntities, reps, [&]() {
+        for (tCD_Handle entity : handles)
+            lookupSum += world.get<BenchVelocity>(entity)->x;
+    });
+    sink = lookupSum + world.get<BenchPosition>(handles.back())->x;
+
+    std::cout << std::setw(8) << numEntities
+              << std::setw(12) << entityUpdate
+              << std::setw(12) << ecsUpdate
+              << std::setw(12) << entityLookup
+              << std::setw(12) << ecsLookup << std::endl;
+}
+
+int main() {
+    std::cout << std::fixed << std::setprecision(2);
+
+    std::cout << "Body/transform sync, both directions (ns per body)" << std::endl;
+    std::cout << std::setw(8) << "bodies"
+              << std::setw(12) << "map"
+              << std::setw(12) << "dense"
+              << std::setw(12) << "dense SoA" << std::endl;
+    for (size_t numBodies : {1000, 10000, 50000}) {
+        benchBodySync(numBodies);
+    }
+
+    std::cout << std::endl << "Fixed-step frame sync by threads (ns per body)" << std::endl;
+    std::cout << std::setw(8) << "bodies"
+              << std::setw(12) << "1"
+              << std::setw(12) << "2"
+              << std::setw(12) << "4"
+              << std::setw(12) << "8" << std::endl;
+    for (size_t numBodies : {10000, 50000, 200000}) {
+        benchParallelSync(numBodies);
+    }
+
+    std::cout << std::endl << "Node hierarchy update (ns per node)" << std::endl;
+    std::cout << std::setw(8) << "nodes"
+              << std::setw(12) << "all moving"
+              << std::setw(12) << "1% moving"
+              << std::setw(12) << "4 threads" << std::endl;
+    for (size_t numNodes : {1000, 10000, 100000}) {
+        std::cout << std::setw(8) << numNodes
+                  << std::setw(12) << timeNodeUpdate(numNodes, 1)
+                  << std::setw(12) << timeNodeUpdate(numNodes, 100)
+                  << std::setw(12) << timeNodeUpdate(numNodes, 1, 4) << std::endl;
+    }
+
+    std::cout << std::endl << "Entity update and lookup (ns per entity)" << std::endl;
+    std::cout << std::setw(8) << "entities"
+              << std::setw(12) << "Entity"
+              << std::setw(12) << "ECS"
+              << std::setw(12) << "Entity get"
+              << std::setw(12) << "ECS get" << std::endl;
+    for (size_t numEntities : {1000, 10000, 100000}) {
+        benchEntities(numEntities);
+    }
+
+    // "80% static" has 4 in 5 bodies static
+    std::cout << std::endl << "Physics step (ms per step)" << std::endl;
+    std::cout << std::setw(8) << "bodies"
+              << std::setw(12) << "native"
+              << std::setw(12) << "80% static";
+#ifdef CD_BENCHMARK_QUANTUM
+    std::cout << std::setw(12) << "quantum";
+#endif
+    std::cout << std::endl;
+    for (size_t numBodies : {1000, 5000, 20000, 50000}) {
+        benchPhysics(numBodies);
+    }
+
+    std::cout << std::endl << "Bullets (ms per step)" << std::endl;
+    std::cout << std::setw(8) << "bullets"
+              << std::setw(12) << "unfiltered"
+              << std::setw(12) << "masked" << std::endl;
+    for (size_t numBullets : {1000, 5000, 10000}) {
+        std::cout << std::setw(8) << numBullets
+                  << std::setw(12) << timeBullets(numBullets, false)
+                  << std::setw(12) << timeBullets(numBullets, true) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,384 @@
+/*
+    Copyright 2017 Ahnaf Siddiqui
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+/**
+ * Builds an asset bundle (see CD_BundleFormat.h) from a manifest file.
+ *
+ * Usage: cdbundle <manifest> <output> [atlas page size]
+ *
+ * Each line of the manifest is one of:
+ *   image <name> <path>
+ *   sprite <name> <path>
+ *   config <name> <path>
+ *   animation <name> <image or sprite name> <frame length> <num frames> <rows> <columns>
+ * Blank lines and lines starting with # are ignored.
+ *
+ * Images are decoded to RGBA32 pixels. Sprites are also packed
+ * into shared atlas pages, named atlas/0, atlas/1 and so on.
+ * Configs are parsed into key-value pairs, one "key: value" per line.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+// cdbundle has its own main
+#define SDL_MAIN_HANDLED
+#include "SDL.h"
+#include "SDL_image.h"
+#include "CD_BundleFormat.h"
+#include "CD_SkylinePacker.h"
+
+// keeps filtering from bleeding neighboring sprites into each other
+static const int SPRITE_PADDING = 1;
+
+struct Item {
+    std::string name;
+    dBundleEntry entry;
+
+    // name of the image a sprite is on,
+    // or of the image or sprite an animation uses
+    std::string ref;
+
+    std::vector<char> pixels;
+    std::vector<std::pair<std::string, std::string> > pairs;
+
+    uint32_t dataAlign;
+    std::vector<char> data;
+};
+
+static Item makeItem(const std::string& name, uint32_t type) {
+    Item item;
+    item.name = name;
+    std::memset(&item.entry, 0, sizeof(item.entry));
+    item.entry.type = type;
+    return item;
+}
+
+static std::string trim(const std::string& str) {
+    auto begin = str.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    auto end = str.find_last_not_of(" \t\r");
+    return str.substr(begin, end - begin + 1);
+}
+
+static bool loadPixels(const std::string& path, Item& item, int& width, int& height) {
+    auto image = IMG_Load(path.c_str());
+    if (!image) {
+        std::cerr << "Failed to load " << path << ": " << IMG_GetError() << std::endl;
+        return false;
+    }
+
+    auto rgba = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(image);
+    if (!rgba) {
+        std::cerr << "Failed to convert " << path << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    width = rgba->w;
+    height = rgba->h;
+
+    // rows are stored without the surface's pitch padding
+    item.pixels.resize((size_t)width * height * 4);
+    for (int y = 0; y < height; ++y) {
+        std::memcpy(&item.pixels[(size_t)y * width * 4],
+                    (const char*)rgba->pixels + (size_t)y * rgba->pitch,
+                    (size_t)width * 4);
+    }
+
+    SDL_FreeSurface(rgba);
+    return true;
+}
+
+static bool loadConfig(const std::string& path, Item& item) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        auto delim = line.find(':');
+        if (delim == std::string::npos) {
+            std::cerr << path << ": ignoring line without a ':': " << line << std::endl;
+            continue;
+        }
+        item.pairs.push_back({trim(line.substr(0, delim)), trim(line.substr(delim + 1))});
+    }
+    return true;
+}
+
+static bool readManifest(const std::string& path,
+                         std::vector<Item>& items,
+                         std::vector<Item>& sprites) {
+    std::ifstream manifest(path);
+    if (!manifest.is_open()) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNum = 0;
+    while (std::getline(manifest, line)) {
+        ++lineNum;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream words(line);
+        std::string kind, name;
+        words >> kind >> name;
+
+        if (kind == "image" || kind == "sprite") {
+            std::string imagePath;
+            words >> imagePath;
+
+            Item item = makeItem(name, kind == "image" ? CD_BUNDLE_IMAGE : CD_BUNDLE_SPRITE);
+            int w, h;
+            if (!loadPixels(imagePath, item, w, h)) return false;
+
+            if (kind == "image") {
+                item.entry.image.width = w;
+                item.entry.image.height = h;
+                items.push_back(item);
+            }
+            else {
+                item.entry.sprite.w = w;
+                item.entry.sprite.h = h;
+                sprites.push_back(item);
+            }
+        }
+        else if (kind == "config") {
+            std::string configPath;
+            words >> configPath;
+
+            Item item = makeItem(name, CD_BUNDLE_CONFIG);
+            if (!loadConfig(configPath, item)) return false;
+            item.entry.config.numPairs = item.pairs.size();
+            items.push_back(item);
+        }
+        else if (kind == "animation") {
+            Item item = makeItem(name, CD_BUNDLE_ANIMATION);
+            auto& animation = item.entry.animation;
+            words >> item.ref >> animation.frameLength >> animation.numFrames
+                  >> animation.rows >> animation.columns;
+            if (!words) {
+                std::cerr << path << ":" << lineNum << ": incomplete animation" << std::endl;
+                return false;
+            }
+            items.push_back(item);
+        }
+        else {
+            std::cerr << path << ":" << lineNum << ": unknown entry " << kind << std::endl;
+            return false;
+        }
+
+        if (name.empty()) {
+            std::cerr << path << ":" << lineNum << ": missing name" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Packs the sprites into atlas pages, which are added to items along with the sprites.
+static bool packSprites(std::vector<Item>& sprites, int pageSize, std::vector<Item>& items) {
+    // packing the tallest sprites first leaves the least wasted space
+    std::sort(sprites.begin(), sprites.end(), [](const Item& a, const Item& b) {
+        return a.entry.sprite.h > b.entry.sprite.h;
+    });
+
+    std::vector<CDSkylinePacker> packers;
+    std::vector<int> spritePages;
+
+    for (auto& sprite : sprites) {
+        // no padding is needed past the edge of the page
+        int w = std::min(sprite.entry.sprite.w + SPRITE_PADDING, pageSize);
+        int h = std::min(sprite.entry.sprite.h + SPRITE_PADDING, pageSize);
+        int page = -1;
+
+        for (size_t i = 0; i < packers.size() && page < 0; ++i) {
+            if (packers[i].insert(w, h, sprite.entry.sprite.x, sprite.entry.sprite.y))
+                page = i;
+        }
+        if (page < 0) {
+            packers.emplace_back(pageSize, pageSize);
+            if (!packers.back().insert(w, h, sprite.entry.sprite.x, sprite.entry.sprite.y)) {
+                std::cerr << "Sprite " << sprite.name << " is bigger than the atlas page size" << std::endl;
+                return false;
+            }
+            page = packers.size() - 1;
+        }
+
+        spritePages.push_back(page);
+        sprite.ref = "atlas/" + std::to_string(page);
+    }
+
+    std::vector<Item> pages;
+    for (size_t i = 0; i < packers.size(); ++i) {
+        Item page = makeItem("atlas/" + std::to_string(i), CD_BUNDLE_IMAGE);
+        page.entry.image.width = packers[i].usedWidth();
+        page.entry.image.height = packers[i].usedHeight();
+        page.pixels.resize((size_t)page.entry.image.width * page.entry.image.height * 4, 0);
+        pages.push_back(page);
+    }
+
+    for (size_t s = 0; s < sprites.size(); ++s) {
+        auto& sprite = sprites[s];
+        auto& page = pages[spritePages[s]];
+        auto& rect = sprite.entry.sprite;
+        for (int y = 0; y < rect.h; ++y) {
+            std::memcpy(&page.pixels[((size_t)(rect.y + y) * page.entry.image.width + rect.x) * 4],
+                        &sprite.pixels[(size_t)y * rect.w * 4],
+                        (size_t)rect.w * 4);
+        }
+        sprite.pixels.clear();
+    }
+
+    items.insert(items.end(), pages.begin(), pages.end());
+    items.insert(items.end(), sprites.begin(), sprites.end());
+
+    if (!pages.empty())
+        std::cout << sprites.size() << " sprites packed into " << pages.size() << " atlas pages" << std::endl;
+    return true;
+}
+
+static uint32_t alignUp(uint32_t offset) {
+    return (offset + CD_BUNDLE_DATA_ALIGN - 1) / CD_BUNDLE_DATA_ALIGN * CD_BUNDLE_DATA_ALIGN;
+}
+
+static bool writeBundle(const std::string& path, std::vector<Item>& items) {
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return std::strcmp(a.name.c_str(), b.name.c_str()) < 0;
+    });
+
+    std::map<std::string, int> indices;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (!indices.insert({items[i].name, (int)i}).second) {
+            std::cerr << "Duplicate entry name " << items[i].name << std::endl;
+            return false;
+        }
+    }
+
+    // resolve references by name now that entries are in their final order
+    for (auto& item : items) {
+        if (item.entry.type == CD_BUNDLE_SPRITE) {
+            item.entry.sprite.image = indices[item.ref];
+        }
+        else if (item.entry.type == CD_BUNDLE_ANIMATION) {
+            auto ref = indices.find(item.ref);
+            if (ref == indices.end() ||
+                (items[ref->second].entry.type != CD_BUNDLE_IMAGE &&
+                 items[ref->second].entry.type != CD_BUNDLE_SPRITE)) {
+                std::cerr << "Animation " << item.name << " uses unknown image " << item.ref << std::endl;
+                return false;
+            }
+            item.entry.animation.spritesheet = ref->second;
+        }
+    }
+
+    // strings come right after the entries
+    std::vector<char> strings;
+    uint32_t stringsOffset = sizeof(dBundleHeader) + items.size() * sizeof(dBundleEntry);
+    auto addString = [&strings, stringsOffset](const std::string& str) {
+        uint32_t offset = stringsOffset + strings.size();
+        strings.insert(strings.end(), str.begin(), str.end());
+        strings.push_back('\0');
+        return offset;
+    };
+
+    for (auto& item : items) {
+        item.entry.nameOffset = addString(item.name);
+
+        if (item.entry.type == CD_BUNDLE_IMAGE) {
+            item.data.swap(item.pixels);
+        }
+        else if (item.entry.type == CD_BUNDLE_CONFIG) {
+            std::vector<dBundleConfigPair> pairs;
+            for (auto& pair : item.pairs) {
+                pairs.push_back({addString(pair.first), addString(pair.second)});
+            }
+            item.data.resize(pairs.size() * sizeof(dBundleConfigPair));
+            if (!pairs.empty()) std::memcpy(&item.data[0], &pairs[0], item.data.size());
+        }
+    }
+
+    uint32_t offset = stringsOffset + strings.size();
+    for (auto& item : items) {
+        offset = alignUp(offset);
+        item.entry.dataOffset = offset;
+        item.entry.dataSize = item.data.size();
+        offset += item.data.size();
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    dBundleHeader header;
+    std::memcpy(header.magic, CD_BUNDLE_MAGIC, 4);
+    header.version = CD_BUNDLE_VERSION;
+    header.numEntries = items.size();
+    header.entriesOffset = sizeof(dBundleHeader);
+    out.write((const char*)&header, sizeof(header));
+
+    for (auto& item : items) {
+        out.write((const char*)&item.entry, sizeof(item.entry));
+    }
+    out.write(strings.data(), strings.size());
+
+    for (auto& item : items) {
+        static const char padding[CD_BUNDLE_DATA_ALIGN] = {};
+        out.write(padding, item.entry.dataOffset - (uint32_t)out.tellp());
+        out.write(item.data.data(), item.data.size());
+    }
+
+    // lets readers check that names are terminated within the file
+    out.put('\0');
+
+    std::cout << "Wrote " << items.size() << " entries to " << path << std::endl;
+    return out.good();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: cdbundle <manifest> <output> [atlas page size]" << std::endl;
+        return 1;
+    }
+
+    int pageSize = argc > 3 ? std::atoi(argv[3]) : 2048;
+
+    std::vector<Item> items, sprites;
+    bool success = readManifest(argv[1], items, sprites) &&
+                   packSprites(sprites, pageSize, items) &&
+                   writeBundle(argv[2], items);
+
+    IMG_Quit();
+    return success ? 0 : 1;
+}
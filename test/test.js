@@ -49,4 +49,276 @@ describe('Diamond', function() {
 
     // TODO: more tests!
   });
+
+  describe('Transform2 parenting', function() {
+    it('children follow their parent and keep their offset', function() {
+      let parent = new Diamond.Transform2({x: 10, y: 0});
+      let child = new Diamond.Transform2({x: 12, y: 0});
+      assert.equal(parent.addChild(child), true);
+      assert.strictEqual(child.parent, parent);
+      assert.equal(child.addChild(parent), false);
+
+      parent.position = {x: 20, y: 5};
+      Diamond.updateNodes();
+      assert(floatEQ(child.position.x, 22));
+      assert(floatEQ(child.position.y, 5));
+
+      child.setLocal({x: 0, y: 3});
+      Diamond.updateNodes();
+      assert(floatEQ(child.position.x, 20));
+      assert(floatEQ(child.position.y, 8));
+
+      assert.equal(parent.removeChild(child), true);
+      assert.strictEqual(child.parent, null);
+      parent.position = {x: 0, y: 0};
+      Diamond.updateNodes();
+      assert(floatEQ(child.position.x, 20));
+
+      child.destroy();
+      parent.destroy();
+    });
+  });
+
+  describe('systems', function() {
+    it('built-in systems are timed in the order they run', function() {
+      const timings = Diamond.systems.timings;
+      assert.deepEqual(timings.map(timing => timing.name),
+                       ['movers', 'tweens', 'nodes', 'animation', 'particles']);
+      timings.forEach(timing => assert.equal(timing.timeMs, 0));
+    });
+  });
+
+  describe('animation', function() {
+    it('no animations finish before the first frame', function() {
+      assert.deepEqual(Diamond.animation.finished, []);
+    });
+  });
+
+  describe('movers', function() {
+    it('single and bulk movers keep their velocities', function() {
+      const transform = new Diamond.Transform2();
+      const mover = new Diamond.Mover(transform);
+      mover.velocity = {x: 0.5, y: -0.25};
+      mover.angularVelocity = 0.1;
+      assert(floatEQ(mover.velocity.x, 0.5));
+      assert(floatEQ(mover.velocity.y, -0.25));
+      assert(floatEQ(mover.angularVelocity, 0.1));
+
+      const transforms = [new Diamond.Transform2(), new Diamond.Transform2()];
+      const handles = Diamond.movers.make(transforms);
+      Diamond.movers.setVelocities(handles, new Float32Array([1, 2, 3, 4]));
+      const velocities = Diamond.movers.getVelocities(handles);
+      assert(floatEQ(velocities[1], 2));
+      assert(floatEQ(velocities[2], 3));
+
+      Diamond.movers.destroy(handles);
+      transforms.forEach(t => t.destroy());
+      transform.destroy();
+      assert.strictEqual(transform.mover, undefined);
+    });
+
+    it('update moves transforms by velocity', function() {
+      const transform = new Diamond.Transform2();
+      const mover = new Diamond.Mover(transform);
+      mover.velocity = {x: 0.5, y: -0.25};
+      Diamond.movers.update(10);
+      assert(floatEQ(transform.position.x, 5));
+      assert(floatEQ(transform.position.y, -2.5));
+      transform.destroy();
+    });
+  });
+
+  describe('tween', function() {
+    it('tweens can be chained and are destroyed with their target', function() {
+      const transform = new Diamond.Transform2();
+      const move = new Diamond.Tween(transform, 'position', {x: 10, y: 5},
+                                     {duration: 200, easing: 'quadOut'});
+      const spin = new Diamond.Tween(transform, 'rotation', 360,
+                                     {relative: true, loops: -1});
+      assert.strictEqual(move.then(spin), spin);
+      assert.deepEqual(Diamond.tween.finished, []);
+      // tweens only run in the game loop
+      assert(floatEQ(transform.position.x, 0));
+      transform.destroy();
+    });
+
+    it('update runs a linear tween to its target', function() {
+      const transform = new Diamond.Transform2();
+      const move = new Diamond.Tween(transform, 'position', {x: 10, y: 5},
+                                     {duration: 100});
+      Diamond.tween.update(50);
+      assert(floatEQ(transform.position.x, 5));
+      assert(floatEQ(transform.position.y, 2.5));
+      assert.deepEqual(Diamond.tween.finished, []);
+      Diamond.tween.update(60);
+      assert(floatEQ(transform.position.x, 10));
+      assert(floatEQ(transform.position.y, 5));
+      assert.deepEqual(Diamond.tween.finished, [move]);
+      transform.destroy();
+    });
+
+    it('a chained tween starts after the first finishes', function() {
+      const transform = new Diamond.Transform2();
+      const move = new Diamond.Tween(transform, 'position', {x: 10, y: 0},
+                                     {duration: 100});
+      const spin = move.then(new Diamond.Tween(transform, 'rotation', 90,
+                                               {duration: 100}));
+      Diamond.tween.update(100);
+      assert(floatEQ(transform.position.x, 10));
+      assert(floatEQ(transform.rotation, 0));
+      assert.deepEqual(Diamond.tween.finished, [move]);
+      Diamond.tween.update(50);
+      assert(floatEQ(transform.rotation, 45));
+      Diamond.tween.update(50);
+      assert(floatEQ(transform.rotation, 90));
+      assert.deepEqual(Diamond.tween.finished, [spin]);
+      transform.destroy();
+    });
+
+    it('destroying a finished tween leaves the tween that reused its handle', function() {
+      const transform = new Diamond.Transform2();
+      const first = new Diamond.Tween(transform, 'rotation', 10, {duration: 10});
+      Diamond.tween.update(10);
+      // finished handles are reused after the next update
+      Diamond.tween.update(0);
+      const second = new Diamond.Tween(transform, 'position', {x: 10, y: 0},
+                                       {duration: 100});
+      assert.strictEqual(second.handle, first.handle);
+      first.destroy();
+      Diamond.tween.update(50);
+      assert(floatEQ(transform.position.x, 5));
+      second.destroy();
+      transform.destroy();
+    });
+  });
+
+  describe('physics', function() {
+    it('there are no collisions before the first physics step', function() {
+      assert.deepEqual(Diamond.physics.collisions, []);
+    });
+
+    it('rigidbodies keep their type', function() {
+      const transform = new Diamond.Transform2();
+      const wall = new Diamond.Rigidbody2D(transform, 'static');
+      const body = new Diamond.Rigidbody2D(transform);
+      assert.equal(wall.type, 'static');
+      assert.equal(body.type, 'dynamic');
+      wall.destroy();
+      body.destroy();
+      transform.destroy();
+    });
+
+    it('queries in empty space find nothing', function() {
+      const far = {x: -1e6, y: -1e6};
+      assert.equal(Diamond.physics.raycast(far, {x: -1e6 + 10, y: -1e6}), null);
+      assert.deepEqual(Diamond.physics.queryPoint(far), []);
+      assert.deepEqual(Diamond.physics.queryCircle(far, 5), []);
+      const fractions = Diamond.physics.raycastBatch(
+        new Float32Array([far.x, far.y, far.x + 10, far.y, far.x, far.y, far.x, far.y + 10])
+      );
+      assert.deepEqual(Array.from(fractions), [-1, -1]);
+      assert.deepEqual(Diamond.physics.queryPointBatch(
+        new Float32Array([far.x, far.y, far.x + 1, far.y])
+      ), [[], []]);
+      assert.deepEqual(Diamond.physics.queryAABBBatch(
+        new Float32Array([far.x, far.y, far.x + 1, far.y + 1])
+      ), [[]]);
+      assert.deepEqual(Diamond.physics.queryCircleBatch(
+        new Float32Array([far.x, far.y, 5]), 0, 0x2
+      ), [[]]);
+    });
+
+    it('bulk velocities and impulses', function() {
+      const transform = new Diamond.Transform2();
+      const bodies = [new Diamond.Rigidbody2D(transform), new Diamond.Rigidbody2D(transform)];
+      const handles = Int32Array.from(bodies, body => body.handle);
+      Diamond.physics.setVelocities(handles, new Float32Array([1, 2, 3, 4]));
+      Diamond.physics.applyImpulses(handles, new Float32Array([1, 1, -1, -1]));
+      assert.deepEqual(Array.from(Diamond.physics.getVelocities(handles)), [2, 3, 2, 3]);
+      Diamond.physics.setAngularVelocities(handles, new Float32Array([0.5, -0.5]));
+      assert.equal(bodies[1].angularVelocity, -0.5);
+      bodies.forEach(body => body.destroy());
+      transform.destroy();
+    });
+
+    it('colliders keep their filter', function() {
+      const transform = new Diamond.Transform2();
+      const body = new Diamond.Rigidbody2D(transform);
+      const bullet = new Diamond.CircleCollider(
+        body, {center: {x: 0, y: 0}, radius: 2}, {category: 2, mask: ~2}
+      );
+      assert.equal(bullet.layer, 0);
+      assert.equal(bullet.category, 2);
+      bullet.mask = 0xFFFFFFFF;
+      assert.equal(bullet.mask, 0xFFFFFFFF);
+      bullet.destroy();
+      body.destroy();
+      transform.destroy();
+    });
+
+    it('reshaping a polygon collider keeps its handle and layer', function() {
+      const transform = new Diamond.Transform2();
+      const body = new Diamond.Rigidbody2D(transform);
+      const poly = new Diamond.PolygonCollider(body, [{x: 0, y: 0}, {x: 10, y: 0}, {x: 0, y: 10}]);
+      poly.layer = 3;
+      const handle = poly.handle;
+      poly.points = [{x: 0, y: 0}, {x: 20, y: 0}, {x: 20, y: 20}, {x: 0, y: 20}];
+      assert.equal(poly.handle, handle);
+      assert.equal(poly.layer, 3);
+      assert.equal(poly.points.length, 4);
+      poly.destroy();
+      body.destroy();
+      transform.destroy();
+    });
+
+    it('polygons of less than 3 points are ignored', function() {
+      const transform = new Diamond.Transform2();
+      const body = new Diamond.Rigidbody2D(transform);
+      const poly = new Diamond.PolygonCollider(body, [{x: 0, y: 0}, {x: 10, y: 0}, {x: 0, y: 10}]);
+      poly.points = [{x: 0, y: 0}, {x: 10, y: 10}];
+      poly.points = [];
+      assert.equal(poly.points.length, 3);
+      assert.deepEqual(Diamond.physics.queryAABB({x: 1, y: 1}, {x: 2, y: 2}), [poly]);
+      assert.deepEqual(Diamond.physics.queryCircle({x: 50, y: 50}, 1), []);
+
+      const line = new Diamond.PolygonCollider(body, [{x: 0, y: 0}, {x: 10, y: 10}]);
+      assert(line.handle < 0);
+      line.destroy();
+      poly.destroy();
+      body.destroy();
+      transform.destroy();
+    });
+  });
+
+  describe('bundle', function() {
+    it('opening a missing bundle returns null', function() {
+      assert.equal(Diamond.bundle.open('missing.cdb'), null);
+    });
+  });
+
+  describe('renderer', function() {
+    it('stats are empty before the first frame is rendered', function() {
+      const stats = Diamond.renderer.stats;
+      assert.deepEqual(stats.objectsPerLayer, []);
+      assert.equal(stats.objects, 0);
+      assert.equal(stats.drawCalls, 0);
+      assert.equal(stats.textureSwitches, 0);
+    });
+
+    it('texture budget is reported in texture memory stats', function() {
+      Diamond.renderer.textureBudget = 64 * 1024 * 1024;
+      const memory = Diamond.renderer.textureMemory;
+      assert.equal(memory.budget, 64 * 1024 * 1024);
+      assert(memory.referencedBytes <= memory.bytes);
+    });
+
+    it('async texture load of a missing file resolves to null', function() {
+      const load = Diamond.renderer.loadTextureAsync('missing.png');
+      const poll = setInterval(() => Diamond.renderer.updateTextureLoads(), 5);
+      return load.then(texture => {
+        clearInterval(poll);
+        assert.equal(texture, null);
+      });
+    });
+  });
 });